@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# Binários
+dijkstra=./dijkstra.bin
+
+# "-i all" precisa reproduzir a saída de referência, linha a linha. Cada par
+# "s t" respondido por --pairs (bidirecional, com e sem ALT) e por --ch
+# precisa imprimir a mesma distância que "t:d" na linha s da referência.
+echo "Testando consultas de pares contra Dijkstra de origem única"
+for i in inputs/*.txt
+do
+    echo -e "\e[33mInstância $i\e[0m"
+    j=$(basename $i)
+    $dijkstra -f $i -i all -o temp 2> /dev/null
+    diff temp ./outputs/$j > /dev/null
+    if [ $? -eq 0 ]; then
+        echo -e "\e[32mOK (-i all)\e[0m"
+    else
+        echo -e "\e[31mErro (-i all)\e[0m"
+    fi
+
+    n=$(head -n 1 $i | awk '{print $1}')
+    for s in $(seq 1 $n); do for t in $(seq 1 $n); do echo "$s $t"; done; done > pares
+    awk '{ for (t = 1; t <= NF; t++) { split($t, d, ":"); print NR "->" d[1] ": " d[2] } }' ./outputs/$j > esperado
+
+    $dijkstra -f $i --ch-build indice -o temp > /dev/null 2>&1
+    for modo in "-f $i" "-f $i --alt 4" "--ch indice"
+    do
+        $dijkstra $modo --pairs pares -o temp 2> /dev/null
+        sed 's/ (vértices fixados.*//' temp | diff - esperado > /dev/null
+        if [ $? -eq 0 ]; then
+            echo -e "\e[32mOK ($modo)\e[0m"
+        else
+            echo -e "\e[31mErro ($modo)\e[0m"
+        fi
+    done
+    rm -f pares esperado indice temp $i.landmarks
+done
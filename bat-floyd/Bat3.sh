@@ -8,7 +8,7 @@ echo "Testando algoritmo de Floyd-Warshall"
 for i in inputs/*.txt
 do
     echo -e "\e[33mInstância $i\e[0m"
-    $floyd -f $i > temp
+    $floyd -f $i -o temp
 
     j=$(basename $i)
     diff -w temp ./outputs/$j > /dev/null
@@ -18,4 +18,24 @@ do
         echo -e "\e[31mErro\e[0m"
     fi
     rm temp
-done
\ No newline at end of file
+done
+
+# Caminhos de -s conferidos contra a saída de referência; o tamanho do bloco
+# não pode mudar o caminho escolhido entre os de mesmo custo.
+echo "Testando caminhos de Floyd-Warshall (-s)"
+for i in caminhos/*.txt
+do
+    j=$(basename $i)
+    echo -e "\e[33mInstância inputs/$j\e[0m"
+    for bloco in 16 64 1000
+    do
+        $floyd -f inputs/$j -s --algo floyd -b $bloco -o temp
+        diff temp $i > /dev/null
+        if [ $? -eq 0 ]; then
+            echo -e "\e[32mOK (-b $bloco)\e[0m"
+        else
+            echo -e "\e[31mErro (-b $bloco)\e[0m"
+        fi
+        rm temp
+    done
+done
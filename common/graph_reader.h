@@ -0,0 +1,290 @@
+#ifndef GRAFOS_GRAPH_READER_H
+#define GRAFOS_GRAPH_READER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "worker_pool.h"
+
+// Edges read by GraphFileReader::readEdges, in file order. Range checks are
+// left to each tool, which keeps its own rules for bad vertices.
+template <typename Weight>
+struct EdgeRecords {
+    std::vector<int> from;
+    std::vector<int> to;
+    std::vector<Weight> weight;
+
+    size_t size() const { return from.size(); }
+};
+
+enum class EdgeWeight {
+    None,
+    // Always present.
+    Required,
+    // Only follows an edge with both ends in 1..vertices, as dijkstra has
+    // always read it; other edges come back with weight 1.
+    WhenInRange
+};
+
+// Maps the whole input (or reads it, when it cannot be mapped) and parses
+// numbers by hand: no locale, no stream state, no per-token allocation.
+// Whitespace separates tokens as it does for ">>".
+class GraphFileReader {
+private:
+    // Below this, spinning up lanes costs more than parsing the rest.
+    static const size_t PARALLEL_MIN_BYTES = size_t(32) << 20;
+
+    void* mapping;
+    size_t mappingSize;
+    std::string copy;
+    const char* data;
+    const char* cursor;
+    const char* limit;
+
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static void skipSpaces(const char*& p, const char* end) {
+        while (p < end && isSpace(*p)) ++p;
+    }
+
+    template <typename Integer>
+    static bool parseInteger(const char*& p, const char* end, Integer& value) {
+        skipSpaces(p, end);
+        const char* q = p;
+        bool negative = false;
+        if (q < end && (*q == '-' || *q == '+')) negative = *q++ == '-';
+        if (q == end || !isDigit(*q)) return false;
+        uint64_t magnitude = 0;
+        while (q < end && isDigit(*q)) magnitude = magnitude * 10 + static_cast<uint64_t>(*q++ - '0');
+        value = static_cast<Integer>(negative ? 0 - magnitude : magnitude);
+        p = q;
+        return true;
+    }
+
+    static bool parseValue(const char*& p, const char* end, int& value) { return parseInteger(p, end, value); }
+    static bool parseValue(const char*& p, const char* end, long long& value) { return parseInteger(p, end, value); }
+
+    // Up to 15 significant digits and a power of ten up to 1e22 are both
+    // exact doubles, so one multiply or divide rounds correctly; anything
+    // longer goes through strtod on a copy of the token.
+    static bool parseValue(const char*& p, const char* end, double& value) {
+        static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        skipSpaces(p, end);
+        const char* q = p;
+        bool negative = false;
+        if (q < end && (*q == '-' || *q == '+')) negative = *q++ == '-';
+        uint64_t mantissa = 0;
+        int digits = 0, scale = 0;
+        bool any = false;
+        while (q < end && isDigit(*q)) {
+            if (mantissa != 0 || *q != '0') ++digits;
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*q++ - '0');
+            any = true;
+        }
+        if (q < end && *q == '.') {
+            ++q;
+            while (q < end && isDigit(*q)) {
+                if (mantissa != 0 || *q != '0') ++digits;
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*q++ - '0');
+                --scale;
+                any = true;
+            }
+        }
+        if (!any) return false;
+        if (q < end && (*q == 'e' || *q == 'E')) {
+            const char* e = q + 1;
+            bool negativeExponent = false;
+            if (e < end && (*e == '-' || *e == '+')) negativeExponent = *e++ == '-';
+            if (e < end && isDigit(*e)) {
+                int exponent = 0;
+                while (e < end && isDigit(*e)) exponent = std::min(exponent * 10 + (*e++ - '0'), 100000);
+                scale += negativeExponent ? -exponent : exponent;
+                q = e;
+            }
+        }
+        if (digits <= 15 && scale >= -22 && scale <= 22) {
+            double result = static_cast<double>(mantissa);
+            result = scale < 0 ? result / powers[-scale] : result * powers[scale];
+            value = negative ? -result : result;
+        } else {
+            std::string token(p, q);
+            value = std::strtod(token.c_str(), nullptr);
+        }
+        p = q;
+        return true;
+    }
+
+    static bool inRange(int u, int v, int vertices) { return u >= 1 && v >= 1 && u <= vertices && v <= vertices; }
+
+    // Records are whitespace-separated tokens, so one may span lines, as with
+    // ">>". A record that cannot be read whole leaves p where it started.
+    template <typename Weight>
+    static bool parseEdge(const char*& p, const char* end, EdgeWeight mode, int vertices,
+                          EdgeRecords<Weight>& records) {
+        const char* start = p;
+        int u, v;
+        Weight w = 1;
+        bool read = parseValue(p, end, u) && parseValue(p, end, v);
+        if (read && (mode == EdgeWeight::Required || (mode == EdgeWeight::WhenInRange && inRange(u, v, vertices)))) {
+            read = parseValue(p, end, w);
+        }
+        if (!read) {
+            p = start;
+            return false;
+        }
+        records.from.push_back(u);
+        records.to.push_back(v);
+        if (mode != EdgeWeight::None) records.weight.push_back(w);
+        return true;
+    }
+
+    // Cuts [cursor, limit) after newlines into one slice per lane and parses
+    // them side by side. A slice that does not end exactly on a record (a
+    // record spanning lines, trailing text) makes the caller start over
+    // sequentially, so the result never depends on where the cuts fell.
+    template <typename Weight>
+    bool readEdgesParallel(long long count, EdgeWeight mode, int vertices, int threads, EdgeRecords<Weight>& records) {
+        WorkerPool pool(threads);
+        int slices = pool.size();
+        size_t bytes = static_cast<size_t>(limit - cursor);
+        std::vector<const char*> cuts(slices + 1, limit);
+        cuts[0] = cursor;
+        for (int k = 1; k < slices; ++k) {
+            const char* cut = std::max(cuts[k - 1], cursor + bytes / slices * k);
+            const char* newline = static_cast<const char*>(std::memchr(cut, '\n', limit - cut));
+            cuts[k] = newline ? newline + 1 : limit;
+        }
+
+        std::vector<EdgeRecords<Weight>> parts(slices);
+        std::vector<char> complete(slices, 1);
+        pool.parallelFor(slices, [&](int k) {
+            const char* p = cuts[k];
+            const char* end = cuts[k + 1];
+            parts[k].from.reserve((end - p) / 8);
+            parts[k].to.reserve((end - p) / 8);
+            while (static_cast<long long>(parts[k].size()) < count && parseEdge(p, end, mode, vertices, parts[k])) {
+            }
+            skipSpaces(p, end);
+            complete[k] = p == end;
+        });
+
+        size_t total = 0;
+        for (int k = 0; k < slices; ++k) {
+            total += parts[k].size();
+            if (static_cast<long long>(total) >= count) break;
+            if (!complete[k]) return false;
+        }
+        total = std::min(total, static_cast<size_t>(count));
+        records.from.reserve(total);
+        records.to.reserve(total);
+        if (mode != EdgeWeight::None) records.weight.reserve(total);
+        for (int k = 0; k < slices && records.size() < total; ++k) {
+            size_t take = std::min(parts[k].size(), total - records.size());
+            records.from.insert(records.from.end(), parts[k].from.begin(), parts[k].from.begin() + take);
+            records.to.insert(records.to.end(), parts[k].to.begin(), parts[k].to.begin() + take);
+            if (mode != EdgeWeight::None) {
+                records.weight.insert(records.weight.end(), parts[k].weight.begin(), parts[k].weight.begin() + take);
+            }
+            parts[k] = EdgeRecords<Weight>();
+        }
+        cursor = limit;
+        return true;
+    }
+
+public:
+    GraphFileReader() : mapping(MAP_FAILED), mappingSize(0), data(nullptr), cursor(nullptr), limit(nullptr) {}
+
+    ~GraphFileReader() { close(); }
+
+    GraphFileReader(const GraphFileReader&) = delete;
+    GraphFileReader& operator=(const GraphFileReader&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            mappingSize = static_cast<size_t>(info.st_size);
+            mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapping);
+            }
+        }
+        if (mapping == MAP_FAILED) {
+            char block[1 << 16];
+            ssize_t got;
+            while ((got = ::read(fd, block, sizeof(block))) > 0) copy.append(block, static_cast<size_t>(got));
+            data = copy.data();
+            mappingSize = 0;
+        }
+        ::close(fd);
+        cursor = data;
+        limit = data + (mapping != MAP_FAILED ? mappingSize : copy.size());
+        return true;
+    }
+
+    void close() {
+        if (mapping != MAP_FAILED) munmap(mapping, mappingSize);
+        mapping = MAP_FAILED;
+        std::string().swap(copy);
+        data = cursor = limit = nullptr;
+    }
+
+    size_t size() const { return static_cast<size_t>(limit - data); }
+
+    // Like getline: the rest of the current line, without its newline.
+    bool readLine(std::string& line) {
+        if (cursor == limit) return false;
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', limit - cursor));
+        line.assign(cursor, newline ? newline : limit);
+        cursor = newline ? newline + 1 : limit;
+        return true;
+    }
+
+    bool read(int& value) { return parseValue(cursor, limit, value); }
+    bool read(long long& value) { return parseValue(cursor, limit, value); }
+    bool read(double& value) { return parseValue(cursor, limit, value); }
+
+    // Reads up to count edges, stopping early at the first malformed one.
+    // vertices only matters for WhenInRange. threads != 1 parses large
+    // inputs in slices (0 uses every core).
+    template <typename Weight>
+    void readEdges(long long count, EdgeWeight mode, int vertices, int threads, EdgeRecords<Weight>& records) {
+        if (count <= 0) return;
+        if (threads != 1 && static_cast<size_t>(limit - cursor) >= PARALLEL_MIN_BYTES &&
+            readEdgesParallel(count, mode, vertices, threads, records)) {
+            return;
+        }
+        records = EdgeRecords<Weight>();
+        records.from.reserve(std::min<long long>(count, (limit - cursor) / 4 + 1));
+        records.to.reserve(records.from.capacity());
+        if (mode != EdgeWeight::None) records.weight.reserve(records.from.capacity());
+        while (static_cast<long long>(records.size()) < count && parseEdge(cursor, limit, mode, vertices, records)) {
+        }
+        if (mode != EdgeWeight::WhenInRange || static_cast<long long>(records.size()) == count) return;
+
+        // A last edge without its weight was still added by ">>": with the
+        // weight left at 1 at the end of the file, or 0 on a bad token.
+        int u, v;
+        if (parseValue(cursor, limit, u) && parseValue(cursor, limit, v) && inRange(u, v, vertices)) {
+            skipSpaces(cursor, limit);
+            records.from.push_back(u);
+            records.to.push_back(v);
+            records.weight.push_back(cursor == limit ? 1 : 0);
+        }
+    }
+};
+
+#endif
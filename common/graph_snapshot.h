@@ -0,0 +1,322 @@
+#ifndef GRAFOS_GRAPH_SNAPSHOT_H
+#define GRAFOS_GRAPH_SNAPSHOT_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Layout of a "--convert" snapshot: this header, then 8-byte aligned int32
+// and weight arrays at the recorded offsets. Vertices are 1-based as in the
+// text files.
+//  - Edge list: edgeFrom/edgeTo[edges] and its weights, in input order,
+//    keeping only edges with both ends in 1..V.
+//  - CSR: offsets[V + 2], the arcs of v being targets[offsets[v] ..
+//    offsets[v + 1]) with their weights, in edge order. An undirected
+//    snapshot lists every edge at both ends (a self-loop twice), a
+//    directed one only at its tail and adds the transpose without weights.
+// Weights are stored in the type of the tool that converted the file.
+const char SNAPSHOT_MAGIC[4] = {'G', 'R', 'F', 'S'};
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint32_t SNAPSHOT_DIRECTED = 1;
+
+enum SnapshotWeight : uint32_t {
+    SNAPSHOT_UNWEIGHTED = 0,
+    SNAPSHOT_INT32 = 1,
+    SNAPSHOT_INT64 = 2,
+    SNAPSHOT_FLOAT64 = 3
+};
+
+struct GraphSnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertices;
+    uint32_t flags;
+    uint32_t weightType;
+    uint32_t padding;
+    uint64_t edges;
+    uint64_t arcs;
+    uint64_t edgeFromOffset;
+    uint64_t edgeToOffset;
+    uint64_t edgeWeightOffset;
+    uint64_t offsetsOffset;
+    uint64_t targetsOffset;
+    uint64_t arcWeightOffset;
+    uint64_t reverseOffsetsOffset;
+    uint64_t reverseTargetsOffset;
+};
+
+template <typename Weight> struct SnapshotWeightOf;
+template <> struct SnapshotWeightOf<int> { static const uint32_t value = SNAPSHOT_INT32; };
+template <> struct SnapshotWeightOf<long long> { static const uint32_t value = SNAPSHOT_INT64; };
+template <> struct SnapshotWeightOf<double> { static const uint32_t value = SNAPSHOT_FLOAT64; };
+
+inline size_t snapshotWeightBytes(uint32_t type) {
+    return type == SNAPSHOT_INT32 ? 4 : type == SNAPSHOT_UNWEIGHTED ? 0 : 8;
+}
+
+// Read-only mapping of a snapshot. The arrays point into the mapping, which
+// lives as long as this object.
+class GraphSnapshot {
+private:
+    void* mapping;
+    size_t mappingSize;
+    const GraphSnapshotHeader* header;
+
+    template <typename T>
+    const T* section(uint64_t offset) const {
+        return reinterpret_cast<const T*>(static_cast<const char*>(mapping) + offset);
+    }
+
+    bool fits(uint64_t offset, uint64_t bytes) const { return offset <= mappingSize && bytes <= mappingSize - offset; }
+
+    // Only exact conversions: a fraction or an out-of-range value for an
+    // integer T fails.
+    template <typename T>
+    static bool convert(const char* raw, uint32_t type, uint64_t index, T& value) {
+        if (type == SNAPSHOT_INT32 || type == SNAPSHOT_INT64) {
+            int64_t stored;
+            if (type == SNAPSHOT_INT32) {
+                int32_t narrow;
+                std::memcpy(&narrow, raw + index * 4, 4);
+                stored = narrow;
+            } else {
+                std::memcpy(&stored, raw + index * 8, 8);
+            }
+            if (std::is_integral<T>::value &&
+                (stored < std::numeric_limits<T>::min() || stored > std::numeric_limits<T>::max())) {
+                return false;
+            }
+            value = static_cast<T>(stored);
+            return true;
+        }
+        double stored;
+        std::memcpy(&stored, raw + index * 8, 8);
+        if (std::is_integral<T>::value &&
+            (std::trunc(stored) != stored || stored < static_cast<double>(std::numeric_limits<T>::min()) ||
+             stored >= -static_cast<double>(std::numeric_limits<T>::min()))) {
+            return false;
+        }
+        value = static_cast<T>(stored);
+        return true;
+    }
+
+    template <typename T>
+    const T* weightsAs(uint64_t offset, uint64_t count, std::vector<T>& storage) const {
+        if (header->weightType == SnapshotWeightOf<T>::value) return section<T>(offset);
+        storage.resize(count);
+        if (header->weightType == SNAPSHOT_UNWEIGHTED) {
+            std::fill(storage.begin(), storage.end(), T(1));
+            return storage.data();
+        }
+        const char* raw = section<char>(offset);
+        for (uint64_t k = 0; k < count; ++k) {
+            if (!convert(raw, header->weightType, k, storage[k])) return nullptr;
+        }
+        return storage.data();
+    }
+
+public:
+    GraphSnapshot() : mapping(MAP_FAILED), mappingSize(0), header(nullptr) {}
+
+    ~GraphSnapshot() {
+        if (mapping != MAP_FAILED) munmap(mapping, mappingSize);
+    }
+
+    GraphSnapshot(const GraphSnapshot&) = delete;
+    GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+
+    static bool isSnapshot(const std::string& path) {
+        char magic[4] = {0};
+        std::ifstream in(path, std::ios::binary);
+        in.read(magic, 4);
+        return in && std::memcmp(magic, SNAPSHOT_MAGIC, 4) == 0;
+    }
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(GraphSnapshotHeader)) {
+            close(fd);
+            return false;
+        }
+        mappingSize = static_cast<size_t>(info.st_size);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) return false;
+
+        header = static_cast<const GraphSnapshotHeader*>(mapping);
+        uint64_t weightBytes = snapshotWeightBytes(header->weightType);
+        uint64_t offsetBytes = (static_cast<uint64_t>(header->vertices) + 2) * 4;
+        bool valid = std::memcmp(header->magic, SNAPSHOT_MAGIC, 4) == 0 && header->version == SNAPSHOT_VERSION &&
+                     header->weightType <= SNAPSHOT_FLOAT64 && fits(header->edgeFromOffset, header->edges * 4) &&
+                     fits(header->edgeToOffset, header->edges * 4) &&
+                     fits(header->edgeWeightOffset, header->edges * weightBytes) &&
+                     fits(header->offsetsOffset, offsetBytes) && fits(header->targetsOffset, header->arcs * 4) &&
+                     fits(header->arcWeightOffset, header->arcs * weightBytes);
+        if (valid && directed()) {
+            valid = fits(header->reverseOffsetsOffset, offsetBytes) &&
+                    fits(header->reverseTargetsOffset, header->arcs * 4);
+        }
+        return valid;
+    }
+
+    int vertices() const { return static_cast<int>(header->vertices); }
+    long long edgeCount() const { return static_cast<long long>(header->edges); }
+    long long arcCount() const { return static_cast<long long>(header->arcs); }
+    bool directed() const { return (header->flags & SNAPSHOT_DIRECTED) != 0; }
+
+    const int* edgeFrom() const { return section<int>(header->edgeFromOffset); }
+    const int* edgeTo() const { return section<int>(header->edgeToOffset); }
+    const int* offsets() const { return section<int>(header->offsetsOffset); }
+    const int* targets() const { return section<int>(header->targetsOffset); }
+    const int* reverseOffsets() const { return directed() ? section<int>(header->reverseOffsetsOffset) : nullptr; }
+    const int* reverseTargets() const { return directed() ? section<int>(header->reverseTargetsOffset) : nullptr; }
+
+    // Weights as T: the mapped array when stored as T, otherwise converted
+    // into storage (1 for an unweighted snapshot). nullptr when some weight
+    // does not fit T exactly, such as a fraction for an integer tool.
+    template <typename T>
+    const T* edgeWeights(std::vector<T>& storage) const {
+        return weightsAs(header->edgeWeightOffset, header->edges, storage);
+    }
+
+    template <typename T>
+    const T* arcWeights(std::vector<T>& storage) const {
+        return weightsAs(header->arcWeightOffset, header->arcs, storage);
+    }
+};
+
+// Stable counting sort of the arcs tail -> head by tail, over 1-based
+// vertices: the same order the tools get when inserting edges one by one.
+inline void buildSnapshotCsr(int vertices, const std::vector<int>& tails, const std::vector<int>& heads,
+                             std::vector<int>& offsets, std::vector<int>& targets, std::vector<size_t>* order) {
+    offsets.assign(vertices + 2, 0);
+    for (int tail : tails) ++offsets[tail + 1];
+    for (int v = 1; v <= vertices + 1; ++v) offsets[v] += offsets[v - 1];
+    targets.resize(tails.size());
+    if (order) order->resize(tails.size());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t a = 0; a < tails.size(); ++a) {
+        int slot = fill[tails[a]]++;
+        targets[slot] = heads[a];
+        if (order) (*order)[slot] = a;
+    }
+}
+
+// Writes the edges (1-based, as read) of a graph with the given number of
+// vertices; edges with an end outside 1..V are dropped. weights may be null
+// for an unweighted graph.
+template <typename Weight>
+bool writeGraphSnapshot(const std::string& path, int vertices, const std::vector<int>& from, const std::vector<int>& to,
+                        const std::vector<Weight>* weights, bool directed, std::string& error) {
+    std::vector<int> keptFrom, keptTo;
+    std::vector<Weight> keptWeight;
+    for (size_t e = 0; e < from.size(); ++e) {
+        if (from[e] < 1 || to[e] < 1 || from[e] > vertices || to[e] > vertices) continue;
+        keptFrom.push_back(from[e]);
+        keptTo.push_back(to[e]);
+        if (weights) keptWeight.push_back((*weights)[e]);
+    }
+    uint64_t edges = keptFrom.size();
+    uint64_t arcs = directed ? edges : 2 * edges;
+    if (arcs > static_cast<uint64_t>(INT_MAX)) {
+        error = "arestas demais para deslocamentos de 32 bits";
+        return false;
+    }
+
+    // Undirected arcs: each edge gives tail -> head then head -> tail.
+    std::vector<int> tails, heads;
+    if (directed) {
+        tails = keptFrom;
+        heads = keptTo;
+    } else {
+        tails.reserve(arcs);
+        heads.reserve(arcs);
+        for (size_t e = 0; e < edges; ++e) {
+            tails.push_back(keptFrom[e]);
+            heads.push_back(keptTo[e]);
+            tails.push_back(keptTo[e]);
+            heads.push_back(keptFrom[e]);
+        }
+    }
+    std::vector<int> offsets, targets;
+    std::vector<size_t> order;
+    buildSnapshotCsr(vertices, tails, heads, offsets, targets, &order);
+    std::vector<Weight> arcWeight;
+    if (weights) {
+        arcWeight.resize(arcs);
+        for (size_t slot = 0; slot < order.size(); ++slot) {
+            arcWeight[slot] = keptWeight[directed ? order[slot] : order[slot] / 2];
+        }
+    }
+    std::vector<size_t>().swap(order);
+    std::vector<int> reverseOffsets, reverseTargets;
+    if (directed) buildSnapshotCsr(vertices, heads, tails, reverseOffsets, reverseTargets, nullptr);
+    std::vector<int>().swap(tails);
+    std::vector<int>().swap(heads);
+
+    GraphSnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.vertices = static_cast<uint32_t>(vertices);
+    header.flags = directed ? SNAPSHOT_DIRECTED : 0;
+    header.weightType = weights ? SnapshotWeightOf<Weight>::value : SNAPSHOT_UNWEIGHTED;
+    header.edges = edges;
+    header.arcs = arcs;
+
+    uint64_t weightBytes = snapshotWeightBytes(header.weightType);
+    uint64_t position = sizeof(header);
+    auto place = [&](uint64_t bytes) {
+        uint64_t offset = position;
+        position = (position + bytes + 7) & ~uint64_t(7);
+        return offset;
+    };
+    header.edgeFromOffset = place(edges * 4);
+    header.edgeToOffset = place(edges * 4);
+    header.edgeWeightOffset = place(edges * weightBytes);
+    header.offsetsOffset = place(offsets.size() * 4);
+    header.targetsOffset = place(arcs * 4);
+    header.arcWeightOffset = place(arcs * weightBytes);
+    if (directed) {
+        header.reverseOffsetsOffset = place(reverseOffsets.size() * 4);
+        header.reverseTargetsOffset = place(arcs * 4);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    uint64_t written = 0;
+    auto put = [&](uint64_t offset, const void* bytes, uint64_t size) {
+        static const char zeros[8] = {0};
+        out.write(zeros, offset - written);
+        out.write(static_cast<const char*>(bytes), size);
+        written = offset + size;
+    };
+    put(0, &header, sizeof(header));
+    put(header.edgeFromOffset, keptFrom.data(), edges * 4);
+    put(header.edgeToOffset, keptTo.data(), edges * 4);
+    if (weights) put(header.edgeWeightOffset, keptWeight.data(), edges * weightBytes);
+    put(header.offsetsOffset, offsets.data(), offsets.size() * 4);
+    put(header.targetsOffset, targets.data(), arcs * 4);
+    if (weights) put(header.arcWeightOffset, arcWeight.data(), arcs * weightBytes);
+    if (directed) {
+        put(header.reverseOffsetsOffset, reverseOffsets.data(), reverseOffsets.size() * 4);
+        put(header.reverseTargetsOffset, reverseTargets.data(), arcs * 4);
+    }
+    put(position, nullptr, 0);
+    if (!out) error = "falha de escrita";
+    return static_cast<bool>(out);
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef GRAFOS_OUTPUT_WRITER_H
+#define GRAFOS_OUTPUT_WRITER_H
+
+#include <iostream>
+#include <string>
+
+// Decimal digits of value appended in place, as std::to_chars would write
+// them, without a stream or a temporary string.
+inline void appendInteger(std::string& buffer, long long value) {
+    char digits[24];
+    int length = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : value;
+    do {
+        digits[length++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) digits[length++] = '-';
+    while (length > 0) buffer += digits[--length];
+}
+
+// Text results of the tools. Everything goes through one buffer that reaches
+// the file (when there is one) in blocks of about a megabyte, and the console
+// only when echo was asked for. Whatever is left is written by flush() or
+// the destructor.
+class OutputWriter {
+private:
+    static const size_t BLOCK_BYTES = size_t(1) << 20;
+
+    std::ostream* file;
+    bool echo;
+    std::string buffer;
+
+    void spill() {
+        if (buffer.size() >= BLOCK_BYTES) flush();
+    }
+
+public:
+    OutputWriter(std::ostream* out, bool echoConsole) : file(out), echo(echoConsole) {
+        buffer.reserve(BLOCK_BYTES + 4096);
+    }
+    ~OutputWriter() { flush(); }
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    bool echoing() const { return echo; }
+
+    void put(char c) {
+        buffer += c;
+        spill();
+    }
+
+    void put(const char* text) {
+        buffer += text;
+        spill();
+    }
+
+    void put(const std::string& text) {
+        buffer += text;
+        spill();
+    }
+
+    void put(const char* data, size_t size) {
+        buffer.append(data, size);
+        spill();
+    }
+
+    void putInteger(long long value) {
+        appendInteger(buffer, value);
+        spill();
+    }
+
+    void flush() {
+        if (buffer.empty()) return;
+        if (echo) {
+            std::cout.write(buffer.data(), buffer.size());
+            std::cout.flush();
+        }
+        if (file) file->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+};
+
+#endif
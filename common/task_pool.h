@@ -0,0 +1,147 @@
+#ifndef GRAFOS_TASK_POOL_H
+#define GRAFOS_TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for recursive jobs, where a task spawns further tasks
+// while it runs (WorkerPool only splits a fixed count). Every worker owns a
+// deque: it pushes and pops its own work at the back, and idle workers steal
+// the oldest task from the front of someone else's. The thread that calls
+// run() is worker 0, as in WorkerPool.
+class TaskPool {
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<long> pending;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool running;
+    bool stopping;
+
+    static int& currentWorker() {
+        static thread_local int worker = 0;
+        return worker;
+    }
+
+    bool tryRunOne(int self) {
+        std::function<void()> task;
+        {
+            Worker& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+        for (size_t k = 1; !task && k < queues.size(); ++k) {
+            Worker& victim = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        task();
+        --pending;
+        return true;
+    }
+
+    void workerLoop(int self) {
+        currentWorker() = self;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [&] { return stopping || running; });
+                if (stopping) return;
+            }
+            while (pending > 0) {
+                if (!tryRunOne(self)) std::this_thread::yield();
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return stopping || !running; });
+        }
+    }
+
+public:
+    explicit TaskPool(int threadCount) : pending(0), running(false), stopping(false) {
+        if (threadCount <= 0) threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0) threadCount = 1;
+        for (int i = 0; i < threadCount; ++i) queues.emplace_back(new Worker());
+        for (int i = 1; i < threadCount; ++i) threads.emplace_back(&TaskPool::workerLoop, this, i);
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    int size() const { return static_cast<int>(queues.size()); }
+
+    // Only valid from inside a task (or the root passed to run()).
+    void spawn(std::function<void()> task) {
+        ++pending;
+        Worker& own = *queues[currentWorker()];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back(std::move(task));
+    }
+
+    // Runs root and everything it spawns; returns once all of it finished.
+    void run(std::function<void()> root) {
+        currentWorker() = 0;
+        spawn(std::move(root));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = true;
+        }
+        wakeUp.notify_all();
+        while (pending > 0) {
+            if (!tryRunOne(0)) std::this_thread::yield();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wakeUp.notify_all();
+    }
+
+    // Splits [0, count) into chunks of `grain` spawned as tasks and, instead
+    // of blocking, runs pending tasks until its own chunks are done.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        if (count <= grain || queues.size() == 1) {
+            body(0, count);
+            return;
+        }
+        std::atomic<size_t> remaining((count + grain - 1) / grain);
+        for (size_t begin = grain; begin < count; begin += grain) {
+            size_t end = begin + grain < count ? begin + grain : count;
+            spawn([&body, &remaining, begin, end] {
+                body(begin, end);
+                --remaining;
+            });
+        }
+        body(0, grain);
+        --remaining;
+        while (remaining > 0) {
+            if (!tryRunOne(currentWorker())) std::this_thread::yield();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef GRAFOS_WORKER_POOL_H
+#define GRAFOS_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+    const std::function<void(int)>* task;
+    std::atomic<int> nextIndex;
+    int taskCount;
+    int activeWorkers;
+    unsigned long generation;
+    bool stopping;
+
+    void drain() {
+        for (int index = nextIndex++; index < taskCount; index = nextIndex++) {
+            (*task)(index);
+        }
+    }
+
+    void workerLoop() {
+        unsigned long seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            drain();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--activeWorkers == 0) finished.notify_one();
+            }
+        }
+    }
+
+public:
+    explicit WorkerPool(int threads)
+        : task(nullptr), nextIndex(0), taskCount(0), activeWorkers(0), generation(0), stopping(false) {
+        if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+        for (int i = 1; i < threads; ++i) {
+            workers.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    void parallelFor(int count, const std::function<void(int)>& body) {
+        if (workers.empty() || count <= 1) {
+            for (int i = 0; i < count; ++i) body(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &body;
+            taskCount = count;
+            nextIndex = 0;
+            activeWorkers = static_cast<int>(workers.size());
+            ++generation;
+        }
+        wakeUp.notify_all();
+        drain();
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return activeWorkers == 0; });
+    }
+};
+
+#endif
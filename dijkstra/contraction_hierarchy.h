@@ -0,0 +1,420 @@
+#ifndef GRAFOS_CONTRACTION_HIERARCHY_H
+#define GRAFOS_CONTRACTION_HIERARCHY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "priority_queues.h"
+
+// Single-source runs print distances truncated, and with fractional weights
+// the sum they truncate depends on the path: among paths of equal length,
+// Dijkstra from s keeps the smallest sum accumulated edge by edge from s.
+// A point-to-point answer adds the weights in another order, so when it is
+// this close to an integer it is recomputed from s alone.
+inline bool truncationIsAmbiguous(double distance) {
+    return std::fabs(distance - std::round(distance)) <= 1e-9 * std::max(1.0, distance);
+}
+
+// Contraction hierarchy for an undirected graph with non-negative weights.
+// Vertices are contracted in order of importance; when v is contracted its
+// remaining neighbors all rank higher, so the edges v keeps at that moment
+// (original ones and shortcuts) form the upward graph stored in the index.
+// A query runs Dijkstra upward from both ends and meets at the top. With
+// fractional weights the index also keeps which upward edges are original, so
+// the original graph is at hand for answers truncation makes ambiguous.
+class ContractionHierarchy {
+private:
+    typedef std::vector<std::pair<int, double>> Adjacency;
+
+    int numVertices;
+    int coreSize;
+    std::vector<int> upOffsets;
+    std::vector<int> upTargets;
+    std::vector<double> upWeights;
+    std::vector<char> upOriginal;
+    bool fractional;
+    std::vector<int> baseOffsets;
+    std::vector<int> baseTargets;
+    std::vector<double> baseWeights;
+
+    // Builder state, released once the upward graph is frozen.
+    std::vector<Adjacency> remaining;
+    std::vector<char> contracted;
+    std::vector<int> deletedNeighbors;
+    std::vector<double> witnessDistance;
+    std::vector<int> witnessTouched;
+    std::vector<std::pair<int, std::pair<int, double>>> upwardEdges;
+    std::vector<std::pair<std::pair<int, int>, double>> shortcuts;
+    std::vector<std::pair<std::pair<int, int>, double>> directed;
+    std::vector<int> edgeSlot;
+    long long remainingEdges;
+
+    static const int WITNESS_SETTLE_LIMIT = 50;
+    static const int CORE_DEGREE = 16;
+
+    // Local Dijkstra from `from` that avoids `skipped` and gives up past
+    // `limit` or after a fixed number of settled vertices; a missed witness
+    // only costs an extra shortcut.
+    void witnessSearch(int from, int skipped, double limit, DaryHeap& queue) {
+        const double unreachable = std::numeric_limits<double>::max();
+        for (int v : witnessTouched) witnessDistance[v] = unreachable;
+        witnessTouched.clear();
+        queue.clear();
+        witnessDistance[from] = 0;
+        witnessTouched.push_back(from);
+        queue.update(from, unreachable, 0);
+        for (int settled = 0; !queue.empty() && settled < WITNESS_SETTLE_LIMIT; ++settled) {
+            if (queue.topKey() > limit) break;
+            int current = queue.pop();
+            for (const auto& edge : remaining[current]) {
+                if (edge.first == skipped || contracted[edge.first]) continue;
+                double candidate = witnessDistance[current] + edge.second;
+                if (candidate < witnessDistance[edge.first]) {
+                    if (witnessDistance[edge.first] == unreachable) witnessTouched.push_back(edge.first);
+                    queue.update(edge.first, witnessDistance[edge.first], candidate);
+                    witnessDistance[edge.first] = candidate;
+                }
+            }
+        }
+    }
+
+    // Collects in `shortcuts` the edges contracting v would need.
+    void findShortcuts(int v, DaryHeap& queue) {
+        const Adjacency& neighbors = remaining[v];
+        shortcuts.clear();
+        for (size_t a = 0; a < neighbors.size(); ++a) {
+            double limit = 0;
+            for (size_t b = a + 1; b < neighbors.size(); ++b) {
+                limit = std::max(limit, neighbors[a].second + neighbors[b].second);
+            }
+            if (a + 1 == neighbors.size()) break;
+            witnessSearch(neighbors[a].first, v, limit, queue);
+            for (size_t b = a + 1; b < neighbors.size(); ++b) {
+                double through = neighbors[a].second + neighbors[b].second;
+                if (witnessDistance[neighbors[b].first] <= through) continue;
+                shortcuts.push_back(std::make_pair(std::make_pair(neighbors[a].first, neighbors[b].first), through));
+            }
+        }
+    }
+
+    void connect(int from, int to, double weight) {
+        for (auto& edge : remaining[from]) {
+            if (edge.first == to) {
+                edge.second = std::min(edge.second, weight);
+                return;
+            }
+        }
+        remaining[from].emplace_back(to, weight);
+        ++remainingEdges;
+    }
+
+    // Adds both directions of every pending shortcut, grouped by tail so each
+    // adjacency list is indexed once instead of scanned per shortcut.
+    void addShortcuts() {
+        directed.clear();
+        for (const auto& shortcut : shortcuts) {
+            directed.push_back(shortcut);
+            directed.push_back(std::make_pair(std::make_pair(shortcut.first.second, shortcut.first.first), shortcut.second));
+        }
+        std::sort(directed.begin(), directed.end());
+        for (size_t begin = 0; begin < directed.size();) {
+            int from = directed[begin].first.first;
+            Adjacency& edges = remaining[from];
+            for (size_t k = 0; k < edges.size(); ++k) edgeSlot[edges[k].first] = static_cast<int>(k);
+            size_t end = begin;
+            for (; end < directed.size() && directed[end].first.first == from; ++end) {
+                int to = directed[end].first.second;
+                if (edgeSlot[to] >= 0) {
+                    edges[edgeSlot[to]].second = std::min(edges[edgeSlot[to]].second, directed[end].second);
+                } else {
+                    edgeSlot[to] = static_cast<int>(edges.size());
+                    edges.emplace_back(to, directed[end].second);
+                    ++remainingEdges;
+                }
+            }
+            for (const auto& edge : edges) edgeSlot[edge.first] = -1;
+            begin = end;
+        }
+    }
+
+    // Both directions of every original upward edge, as a CSR graph; only
+    // needed when some weight is fractional.
+    void prepareBaseGraph() {
+        fractional = false;
+        for (size_t e = 0; e < upTargets.size(); ++e) {
+            if (upOriginal[e] && upWeights[e] != std::floor(upWeights[e])) fractional = true;
+        }
+        std::vector<int>().swap(baseOffsets);
+        std::vector<int>().swap(baseTargets);
+        std::vector<double>().swap(baseWeights);
+        if (!fractional) return;
+        baseOffsets.assign(numVertices + 2, 0);
+        for (int v = 1; v <= numVertices; ++v) {
+            for (int e = upOffsets[v]; e < upOffsets[v + 1]; ++e) {
+                if (!upOriginal[e]) continue;
+                ++baseOffsets[v + 1];
+                ++baseOffsets[upTargets[e] + 1];
+            }
+        }
+        for (int v = 1; v <= numVertices + 1; ++v) baseOffsets[v] += baseOffsets[v - 1];
+        baseTargets.resize(baseOffsets[numVertices + 1]);
+        baseWeights.resize(baseOffsets[numVertices + 1]);
+        std::vector<int> fill(baseOffsets.begin(), baseOffsets.end() - 1);
+        for (int v = 1; v <= numVertices; ++v) {
+            for (int e = upOffsets[v]; e < upOffsets[v + 1]; ++e) {
+                if (!upOriginal[e]) continue;
+                int slot = fill[v]++;
+                baseTargets[slot] = upTargets[e];
+                baseWeights[slot] = upWeights[e];
+                slot = fill[upTargets[e]]++;
+                baseTargets[slot] = v;
+                baseWeights[slot] = upWeights[e];
+            }
+        }
+    }
+
+    int priority(int v, DaryHeap& queue) {
+        findShortcuts(v, queue);
+        int degree = static_cast<int>(remaining[v].size());
+        return static_cast<int>(shortcuts.size()) - degree + deletedNeighbors[v];
+    }
+
+public:
+    ContractionHierarchy() : numVertices(0), coreSize(0), fractional(false), remainingEdges(0) {}
+
+    int getSize() const { return numVertices; }
+    int getCoreSize() const { return coreSize; }
+    long long getUpwardEdgeCount() const { return static_cast<long long>(upTargets.size()); }
+
+    // Graph must provide getSize() and getNeighbors(v) with targets, weights
+    // and size(), 1-indexed as in Grafo.
+    template <typename Graph>
+    void build(const Graph& graph) {
+        const double unreachable = std::numeric_limits<double>::max();
+        numVertices = graph.getSize();
+        remaining.assign(numVertices + 1, Adjacency());
+        remainingEdges = 0;
+        for (int v = 1; v <= numVertices; ++v) {
+            auto neighbors = graph.getNeighbors(v);
+            for (int e = 0; e < neighbors.size(); ++e) {
+                if (neighbors.targets[e] != v) connect(v, neighbors.targets[e], neighbors.weights[e]);
+            }
+        }
+        contracted.assign(numVertices + 1, 0);
+        deletedNeighbors.assign(numVertices + 1, 0);
+        witnessDistance.assign(numVertices + 1, unreachable);
+        edgeSlot.assign(numVertices + 1, -1);
+
+        DaryHeap witnessQueue(numVertices);
+        DaryHeap order(numVertices);
+        for (int v = 1; v <= numVertices; ++v) {
+            order.update(v, unreachable, priority(v, witnessQueue));
+        }
+        int remainingVertices = numVertices;
+        while (!order.empty()) {
+            // Graphs without a road-like hierarchy end in a dense core where
+            // contraction only multiplies shortcuts; it is left uncontracted.
+            if (remainingEdges > static_cast<long long>(CORE_DEGREE) * remainingVertices) break;
+            int v = order.pop();
+            double current = priority(v, witnessQueue);
+            if (!order.empty() && current > order.topKey()) {
+                order.update(v, unreachable, current);
+                continue;
+            }
+            // shortcuts still holds what priority(v) just found.
+            addShortcuts();
+            contracted[v] = 1;
+            for (const auto& edge : remaining[v]) {
+                upwardEdges.push_back(std::make_pair(v, edge));
+                Adjacency& other = remaining[edge.first];
+                for (size_t k = 0; k < other.size(); ++k) {
+                    if (other[k].first == v) {
+                        other[k] = other.back();
+                        other.pop_back();
+                        break;
+                    }
+                }
+                ++deletedNeighbors[edge.first];
+            }
+            remainingEdges -= 2 * static_cast<long long>(remaining[v].size());
+            --remainingVertices;
+            Adjacency().swap(remaining[v]);
+        }
+        // Core vertices share one level: their edges point both ways, so the
+        // two upward searches become plain Dijkstra inside the core.
+        coreSize = remainingVertices;
+        for (int v = 1; v <= numVertices; ++v) {
+            if (contracted[v]) continue;
+            for (const auto& edge : remaining[v]) upwardEdges.push_back(std::make_pair(v, edge));
+        }
+
+        upOffsets.assign(numVertices + 2, 0);
+        for (const auto& edge : upwardEdges) ++upOffsets[edge.first + 1];
+        for (int v = 1; v <= numVertices + 1; ++v) upOffsets[v] += upOffsets[v - 1];
+        upTargets.resize(upwardEdges.size());
+        upWeights.resize(upwardEdges.size());
+        std::vector<int> fill(upOffsets.begin(), upOffsets.end() - 1);
+        for (const auto& edge : upwardEdges) {
+            int slot = fill[edge.first]++;
+            upTargets[slot] = edge.second.first;
+            upWeights[slot] = edge.second.second;
+        }
+        // An upward edge is original when the graph has that edge with that
+        // weight; a shortcut only replaces one it is strictly shorter than.
+        upOriginal.assign(upTargets.size(), 0);
+        for (int v = 1; v <= numVertices; ++v) {
+            for (int e = upOffsets[v]; e < upOffsets[v + 1]; ++e) edgeSlot[upTargets[e]] = e;
+            auto neighbors = graph.getNeighbors(v);
+            for (int e = 0; e < neighbors.size(); ++e) {
+                int slot = edgeSlot[neighbors.targets[e]];
+                if (slot >= upOffsets[v] && upWeights[slot] == neighbors.weights[e]) upOriginal[slot] = 1;
+            }
+            for (int e = upOffsets[v]; e < upOffsets[v + 1]; ++e) edgeSlot[upTargets[e]] = -1;
+        }
+        prepareBaseGraph();
+
+        std::vector<Adjacency>().swap(remaining);
+        std::vector<std::pair<int, std::pair<int, double>>>().swap(upwardEdges);
+        std::vector<char>().swap(contracted);
+        std::vector<int>().swap(deletedNeighbors);
+        std::vector<double>().swap(witnessDistance);
+        std::vector<int>().swap(edgeSlot);
+        shortcuts.clear();
+        std::vector<std::pair<std::pair<int, int>, double>>().swap(directed);
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        uint32_t vertices = numVertices;
+        uint64_t edges = upTargets.size();
+        out.write("CHX2", 4);
+        out.write(reinterpret_cast<const char*>(&vertices), sizeof(vertices));
+        out.write(reinterpret_cast<const char*>(&edges), sizeof(edges));
+        out.write(reinterpret_cast<const char*>(upOffsets.data()), upOffsets.size() * sizeof(int));
+        out.write(reinterpret_cast<const char*>(upTargets.data()), upTargets.size() * sizeof(int));
+        out.write(reinterpret_cast<const char*>(upWeights.data()), upWeights.size() * sizeof(double));
+        out.write(upOriginal.data(), upOriginal.size());
+        return static_cast<bool>(out);
+    }
+
+    bool load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[4];
+        uint32_t vertices;
+        uint64_t edges;
+        if (!in.read(magic, 4) || std::memcmp(magic, "CHX2", 4) != 0) return false;
+        in.read(reinterpret_cast<char*>(&vertices), sizeof(vertices));
+        in.read(reinterpret_cast<char*>(&edges), sizeof(edges));
+        if (!in) return false;
+        numVertices = static_cast<int>(vertices);
+        coreSize = 0;
+        upOffsets.resize(numVertices + 2);
+        upTargets.resize(edges);
+        upWeights.resize(edges);
+        upOriginal.resize(edges);
+        in.read(reinterpret_cast<char*>(upOffsets.data()), upOffsets.size() * sizeof(int));
+        in.read(reinterpret_cast<char*>(upTargets.data()), upTargets.size() * sizeof(int));
+        in.read(reinterpret_cast<char*>(upWeights.data()), upWeights.size() * sizeof(double));
+        in.read(upOriginal.data(), upOriginal.size());
+        if (!in || upOffsets[numVertices + 1] != static_cast<int>(edges)) return false;
+        prepareBaseGraph();
+        return true;
+    }
+
+    friend class ContractionHierarchyQuery;
+};
+
+// Per-thread query state over a loaded hierarchy. Both searches only climb,
+// and a side stops once its smallest key reaches the best meeting distance.
+class ContractionHierarchyQuery {
+private:
+    const ContractionHierarchy& hierarchy;
+    std::vector<double> distance[2];
+    std::vector<int> touched;
+    DaryHeap queue[2];
+
+    // Dijkstra from s over the original edges until t is settled, reusing
+    // the forward state.
+    double forwardDistance(int s, int t, long long& settled) {
+        const double unreachable = std::numeric_limits<double>::max();
+        for (int v : touched) distance[0][v] = distance[1][v] = unreachable;
+        touched.clear();
+        queue[0].clear();
+        distance[0][s] = 0;
+        touched.push_back(s);
+        queue[0].update(s, unreachable, 0);
+        while (!queue[0].empty()) {
+            int current = queue[0].pop();
+            ++settled;
+            if (current == t) break;
+            for (int e = hierarchy.baseOffsets[current]; e < hierarchy.baseOffsets[current + 1]; ++e) {
+                int next = hierarchy.baseTargets[e];
+                double candidate = distance[0][current] + hierarchy.baseWeights[e];
+                if (candidate < distance[0][next]) {
+                    if (distance[0][next] == unreachable) touched.push_back(next);
+                    queue[0].update(next, distance[0][next], candidate);
+                    distance[0][next] = candidate;
+                }
+            }
+        }
+        return distance[0][t];
+    }
+
+public:
+    explicit ContractionHierarchyQuery(const ContractionHierarchy& ch)
+        : hierarchy(ch), queue{DaryHeap(ch.numVertices), DaryHeap(ch.numVertices)} {
+        distance[0].assign(ch.numVertices + 1, std::numeric_limits<double>::max());
+        distance[1].assign(ch.numVertices + 1, std::numeric_limits<double>::max());
+    }
+
+    double query(int s, int t, long long& settled) {
+        const double unreachable = std::numeric_limits<double>::max();
+        for (int v : touched) distance[0][v] = distance[1][v] = unreachable;
+        touched.clear();
+        queue[0].clear();
+        queue[1].clear();
+        settled = 0;
+
+        double best = unreachable;
+        distance[0][s] = 0;
+        distance[1][t] = 0;
+        touched.push_back(s);
+        touched.push_back(t);
+        queue[0].update(s, unreachable, 0);
+        queue[1].update(t, unreachable, 0);
+        if (s == t) best = 0;
+        while (true) {
+            bool forward = !queue[0].empty() && queue[0].topKey() < best;
+            bool backward = !queue[1].empty() && queue[1].topKey() < best;
+            if (!forward && !backward) break;
+            int side = forward && (!backward || queue[0].topKey() <= queue[1].topKey()) ? 0 : 1;
+            int current = queue[side].pop();
+            ++settled;
+            for (int e = hierarchy.upOffsets[current]; e < hierarchy.upOffsets[current + 1]; ++e) {
+                int next = hierarchy.upTargets[e];
+                double candidate = distance[side][current] + hierarchy.upWeights[e];
+                if (candidate < distance[side][next]) {
+                    if (distance[0][next] == unreachable && distance[1][next] == unreachable) touched.push_back(next);
+                    queue[side].update(next, distance[side][next], candidate);
+                    distance[side][next] = candidate;
+                    if (distance[1 - side][next] != unreachable) {
+                        best = std::min(best, candidate + distance[1 - side][next]);
+                    }
+                }
+            }
+        }
+        if (hierarchy.fractional && best != unreachable && truncationIsAmbiguous(best)) {
+            return forwardDistance(s, t, settled);
+        }
+        return best;
+    }
+};
+
+#endif
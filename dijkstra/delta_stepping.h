@@ -0,0 +1,161 @@
+#ifndef GRAFOS_DELTA_STEPPING_H
+#define GRAFOS_DELTA_STEPPING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "worker_pool.h"
+
+// Delta-stepping (Meyer & Sanders) for non-negative weights. Tentative
+// distances are grouped in buckets of width delta; the smallest non-empty
+// bucket is emptied by parallel rounds over the light edges (weight <= delta)
+// of its vertices, which may put vertices back into it, and the heavy edges
+// of everything it settled are relaxed once afterwards. Lanes lower distances
+// with a compare-and-swap min and record what they improved; buckets are
+// refilled between rounds. A vertex is reprocessed whenever its distance
+// drops, so the result is the same fixpoint Dijkstra reaches.
+//
+// Graph must provide getSize() and getNeighbors(v) with targets, weights and
+// size(), 1-indexed as in Grafo.
+template <typename Graph>
+class DeltaStepping {
+private:
+    static const int PARALLEL_GRAIN = 256;
+
+    const Graph& graph;
+    WorkerPool& pool;
+    int numVertices;
+    double delta;
+    std::unique_ptr<std::atomic<double>[]> distance;
+    // Only the live window of buckets exists: a relaxation lands at most
+    // maxWeight / delta + 1 buckets past the current one.
+    std::vector<std::vector<int>> buckets;
+    std::vector<long long> queuedBucket;
+    std::vector<long long> settledBucket;
+    std::vector<std::vector<int>> improved;
+    std::vector<int> frontier;
+    std::vector<int> settled;
+    size_t pending;
+
+    bool lower(int v, double candidate) {
+        double seen = distance[v].load(std::memory_order_relaxed);
+        while (candidate < seen) {
+            if (distance[v].compare_exchange_weak(seen, candidate, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    void enqueue(int v, long long bucket) {
+        if (queuedBucket[v] == bucket) return;
+        queuedBucket[v] = bucket;
+        buckets[bucket % buckets.size()].push_back(v);
+        ++pending;
+    }
+
+    // Relaxes the light or the heavy edges of `vertices` on every lane, then
+    // queues each improved vertex at no earlier bucket than `earliest`.
+    void relax(const std::vector<int>& vertices, bool light, long long earliest) {
+        int lanes = vertices.size() < static_cast<size_t>(PARALLEL_GRAIN) ? 1 : pool.size();
+        std::atomic<size_t> nextChunk(0);
+        pool.parallelFor(lanes, [&](int lane) {
+            for (size_t begin = nextChunk.fetch_add(PARALLEL_GRAIN); begin < vertices.size();
+                 begin = nextChunk.fetch_add(PARALLEL_GRAIN)) {
+                size_t end = std::min(vertices.size(), begin + PARALLEL_GRAIN);
+                for (size_t k = begin; k < end; ++k) {
+                    int u = vertices[k];
+                    double base = distance[u].load(std::memory_order_relaxed);
+                    auto neighbors = graph.getNeighbors(u);
+                    for (int e = 0; e < neighbors.size(); ++e) {
+                        double weight = neighbors.weights[e];
+                        if ((weight <= delta) != light) continue;
+                        if (lower(neighbors.targets[e], base + weight)) improved[lane].push_back(neighbors.targets[e]);
+                    }
+                }
+            }
+        });
+        for (int lane = 0; lane < lanes; ++lane) {
+            for (int v : improved[lane]) {
+                long long bucket = static_cast<long long>(distance[v].load(std::memory_order_relaxed) / delta);
+                enqueue(v, std::max(bucket, earliest));
+            }
+            improved[lane].clear();
+        }
+    }
+
+    // Moves the live entries of `bucket` into the frontier; entries whose
+    // vertex was requeued elsewhere since are stale and dropped.
+    bool takeFrontier(long long bucket) {
+        std::vector<int>& slot = buckets[bucket % buckets.size()];
+        frontier.clear();
+        for (int v : slot) {
+            if (queuedBucket[v] != bucket) continue;
+            queuedBucket[v] = -1;
+            frontier.push_back(v);
+            if (settledBucket[v] != bucket) {
+                settledBucket[v] = bucket;
+                settled.push_back(v);
+            }
+        }
+        pending -= slot.size();
+        slot.clear();
+        return !frontier.empty();
+    }
+
+public:
+    // requestedDelta <= 0 picks delta from the weights: the largest weight
+    // over the average degree, so a light round touches about one bucket
+    // worth of neighbors, but never below the smallest positive weight.
+    DeltaStepping(const Graph& g, WorkerPool& workers, double requestedDelta)
+        : graph(g), pool(workers), numVertices(g.getSize()), delta(requestedDelta),
+          distance(new std::atomic<double>[g.getSize() + 1]), queuedBucket(g.getSize() + 1, -1),
+          settledBucket(g.getSize() + 1, -1), improved(workers.size()), pending(0) {
+        double maxWeight = 0;
+        double minPositive = std::numeric_limits<double>::max();
+        long long edges = 0;
+        for (int v = 1; v <= numVertices; ++v) {
+            auto neighbors = graph.getNeighbors(v);
+            edges += neighbors.size();
+            for (int e = 0; e < neighbors.size(); ++e) {
+                maxWeight = std::max(maxWeight, neighbors.weights[e]);
+                if (neighbors.weights[e] > 0) minPositive = std::min(minPositive, neighbors.weights[e]);
+            }
+        }
+        if (delta <= 0) {
+            double averageDegree = numVertices > 0 ? static_cast<double>(edges) / numVertices : 1;
+            delta = maxWeight / std::max(1.0, averageDegree);
+            if (minPositive != std::numeric_limits<double>::max()) delta = std::max(delta, minPositive);
+        }
+        // Keeps the bucket window bounded even for a tiny requested delta.
+        if (maxWeight > 0) delta = std::max(delta, maxWeight / (1 << 20));
+        if (delta <= 0) delta = 1;
+        buckets.resize(static_cast<size_t>(maxWeight / delta) + 2);
+    }
+
+    double getDelta() const { return delta; }
+
+    void run(int start, std::vector<double>& result) {
+        const double unreachable = std::numeric_limits<double>::max();
+        for (int v = 0; v <= numVertices; ++v) distance[v].store(unreachable, std::memory_order_relaxed);
+        std::fill(queuedBucket.begin(), queuedBucket.end(), -1);
+        std::fill(settledBucket.begin(), settledBucket.end(), -1);
+        for (auto& slot : buckets) slot.clear();
+        pending = 0;
+
+        distance[start].store(0, std::memory_order_relaxed);
+        enqueue(start, 0);
+        for (long long bucket = 0; pending > 0; ++bucket) {
+            settled.clear();
+            while (takeFrontier(bucket)) relax(frontier, true, bucket);
+            if (!settled.empty()) relax(settled, false, bucket + 1);
+        }
+
+        result.resize(numVertices + 1);
+        for (int v = 0; v <= numVertices; ++v) result[v] = distance[v].load(std::memory_order_relaxed);
+    }
+};
+
+#endif
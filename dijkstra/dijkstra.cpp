@@ -4,124 +4,1010 @@
 #include <fstream>
 #include <limits>
 #include <sstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "priority_queues.h"
+#include "contraction_hierarchy.h"
+#include "delta_stepping.h"
+#include "worker_pool.h"
+#include "graph_reader.h"
+#include "graph_snapshot.h"
+#include "output_writer.h"
 
 using namespace std;
 
+struct NeighborSpan {
+    const int* targets;
+    const double* weights;
+    int count;
+
+    int size() const { return count; }
+};
+
+// Edges are staged as they are read and then frozen into CSR: the neighbors
+// of v are targets/weights[offsets[v], offsets[v + 1]), in insertion order.
+// The views point at those vectors or straight into a mapped snapshot, which
+// uses the same layout.
 class Grafo {
 private:
     int numVertices;
-    vector<vector<pair<int, double>>> adjList;
+    vector<int> edgeFrom;
+    vector<int> edgeTo;
+    vector<double> edgeWeight;
+    vector<int> offsets;
+    vector<int> targets;
+    vector<double> weights;
+    const int* offsetView;
+    const int* targetView;
+    const double* weightView;
+    long long arcCount;
 
 public:
-    Grafo(int vertices) : numVertices(vertices), adjList(vertices + 1) {}
+    Grafo(int vertices)
+        : numVertices(vertices), offsets(vertices + 2, 0), offsetView(offsets.data()), targetView(nullptr),
+          weightView(nullptr), arcCount(0) {}
+
+    Grafo(const Grafo&) = delete;
+    Grafo& operator=(const Grafo&) = delete;
 
     void addEdge(int u, int v, double weight) {
         if (u > 0 && v > 0 && u <= numVertices && v <= numVertices) {
-            adjList[u].emplace_back(v, weight);
-            adjList[v].emplace_back(u, weight);
+            edgeFrom.push_back(u);
+            edgeTo.push_back(v);
+            edgeWeight.push_back(weight);
+        }
+    }
+
+    // Takes over the edges as read, dropping those outside the graph in
+    // place instead of copying them.
+    void adoptEdges(EdgeRecords<double>& records) {
+        size_t kept = 0;
+        for (size_t e = 0; e < records.size(); ++e) {
+            int u = records.from[e], v = records.to[e];
+            if (u <= 0 || v <= 0 || u > numVertices || v > numVertices) continue;
+            records.from[kept] = u;
+            records.to[kept] = v;
+            records.weight[kept] = records.weight[e];
+            ++kept;
         }
+        records.from.resize(kept);
+        records.to.resize(kept);
+        records.weight.resize(kept);
+        edgeFrom.swap(records.from);
+        edgeTo.swap(records.to);
+        edgeWeight.swap(records.weight);
     }
 
-    vector<pair<int, double>> getNeighbors(int vertex) const {
-        return adjList[vertex];
+    void freeze() {
+        for (size_t e = 0; e < edgeFrom.size(); ++e) {
+            ++offsets[edgeFrom[e] + 1];
+            ++offsets[edgeTo[e] + 1];
+        }
+        for (int v = 1; v <= numVertices + 1; ++v) {
+            offsets[v] += offsets[v - 1];
+        }
+        targets.resize(offsets[numVertices + 1]);
+        weights.resize(offsets[numVertices + 1]);
+        vector<int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < edgeFrom.size(); ++e) {
+            int slot = fill[edgeFrom[e]]++;
+            targets[slot] = edgeTo[e];
+            weights[slot] = edgeWeight[e];
+            slot = fill[edgeTo[e]]++;
+            targets[slot] = edgeFrom[e];
+            weights[slot] = edgeWeight[e];
+        }
+        vector<int>().swap(edgeFrom);
+        vector<int>().swap(edgeTo);
+        vector<double>().swap(edgeWeight);
+        offsetView = offsets.data();
+        targetView = targets.data();
+        weightView = weights.data();
+        arcCount = static_cast<long long>(targets.size());
+    }
+
+    // An undirected snapshot is used in place; only integer weights are
+    // copied, as doubles. A directed one is rebuilt from its edge list.
+    // False when a weight cannot be read as a double.
+    bool attach(const GraphSnapshot& snapshot) {
+        if (snapshot.directed()) {
+            vector<double> storage;
+            const double* edgeWeights = snapshot.edgeWeights(storage);
+            if (!edgeWeights) return false;
+            for (long long e = 0; e < snapshot.edgeCount(); ++e) {
+                addEdge(snapshot.edgeFrom()[e], snapshot.edgeTo()[e], edgeWeights[e]);
+            }
+            freeze();
+            return true;
+        }
+        weightView = snapshot.arcWeights(weights);
+        if (!weightView) return false;
+        vector<int>().swap(offsets);
+        offsetView = snapshot.offsets();
+        targetView = snapshot.targets();
+        arcCount = snapshot.arcCount();
+        return true;
+    }
+
+    NeighborSpan getNeighbors(int vertex) const {
+        NeighborSpan span = {targetView + offsetView[vertex], weightView + offsetView[vertex],
+                             offsetView[vertex + 1] - offsetView[vertex]};
+        return span;
     }
 
     int getSize() const { return numVertices; }
+    long long getEdgeCount() const { return arcCount / 2; }
+
+    uint64_t fingerprint() const {
+        uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&](uint64_t value) {
+            hash ^= value;
+            hash *= 1099511628211ULL;
+        };
+        mix(numVertices);
+        for (int v = 0; v <= numVertices + 1; ++v) mix(offsetView[v]);
+        for (long long e = 0; e < arcCount; ++e) {
+            uint64_t bits;
+            memcpy(&bits, &weightView[e], sizeof(bits));
+            mix(targetView[e]);
+            mix(bits);
+        }
+        return hash;
+    }
+
+    bool hasNegativeWeights() const {
+        for (long long e = 0; e < arcCount; ++e) {
+            if (weightView[e] < 0) return true;
+        }
+        return false;
+    }
+
+    bool hasIntegerWeights() const {
+        for (long long e = 0; e < arcCount; ++e) {
+            double weight = weightView[e];
+            if (weight < 0 || weight != static_cast<double>(static_cast<long long>(weight))) return false;
+        }
+        return true;
+    }
 };
 
-vector<double> shortestPaths(Grafo& graph, int start) {
-    int vertices = graph.getSize();
-    vector<double> distances(vertices + 1, numeric_limits<double>::max());
-    set<pair<double, int>> unvisited;
+// distances must hold max() everywhere and unvisited must be empty; both are
+// left for the caller to reuse on the next source.
+template <typename Queue>
+void shortestPathsInto(const Grafo& graph, int start, vector<double>& distances, Queue& unvisited,
+                       long long* operations) {
+    long long count = 1;
 
     distances[start] = 0;
-    unvisited.insert({0, start});
+    unvisited.update(start, numeric_limits<double>::max(), 0);
 
     while (!unvisited.empty()) {
-        int current = unvisited.begin()->second;
-        unvisited.erase(unvisited.begin());
+        int current = unvisited.pop();
+        ++count;
 
-        vector<pair<int, double>> neighbors = graph.getNeighbors(current);
-        for (const auto& neighbor : neighbors) {
-            int nextVertex = neighbor.first;
-            double weight = neighbor.second;
+        NeighborSpan neighbors = graph.getNeighbors(current);
+        for (int e = 0; e < neighbors.size(); ++e) {
+            int nextVertex = neighbors.targets[e];
+            double weight = neighbors.weights[e];
             double newDist = distances[current] + weight;
 
             if (newDist < distances[nextVertex]) {
-                unvisited.erase({distances[nextVertex], nextVertex});
+                unvisited.update(nextVertex, distances[nextVertex], newDist);
                 distances[nextVertex] = newDist;
-                unvisited.insert({newDist, nextVertex});
+                ++count;
             }
         }
     }
 
+    if (operations) *operations = count;
+}
+
+template <typename Queue>
+vector<double> shortestPathsWith(const Grafo& graph, int start, long long* operations) {
+    vector<double> distances(graph.getSize() + 1, numeric_limits<double>::max());
+    Queue unvisited(graph.getSize());
+    shortestPathsInto(graph, start, distances, unvisited, operations);
     return distances;
 }
 
+// The radix heap needs non-negative integer weights; callers check
+// hasIntegerWeights() before asking for it.
+vector<double> shortestPaths(const Grafo& graph, int start, const string& queue = "dary",
+                             long long* operations = nullptr) {
+    if (queue == "set") return shortestPathsWith<SetQueue>(graph, start, operations);
+    if (queue == "radix") return shortestPathsWith<RadixHeap>(graph, start, operations);
+    if (queue == "pairing") return shortestPathsWith<PairingHeap>(graph, start, operations);
+    return shortestPathsWith<DaryHeap>(graph, start, operations);
+}
+
+// Distances from a few landmarks give the ALT lower bound
+// d(v, t) >= |d(L, t) - d(L, v)| (the graph is undirected). They are stored
+// next to the graph as <graph>.landmarks and reused while the graph matches.
+class Landmarks {
+private:
+    int numVertices;
+    vector<int> landmarks;
+    vector<vector<double>> distances;
+
+public:
+    Landmarks() : numVertices(0) {}
+
+    int count() const { return static_cast<int>(landmarks.size()); }
+
+    // Farthest selection: each new landmark is the vertex whose closest
+    // landmark is farthest away, starting from the vertex farthest from 1.
+    void select(const Grafo& graph, int wanted) {
+        numVertices = graph.getSize();
+        const double unreachable = numeric_limits<double>::max();
+        vector<double> closest(numVertices + 1, unreachable);
+        vector<double> fromFirst = shortestPaths(graph, 1);
+        int next = 1;
+        for (int v = 1; v <= numVertices; ++v) {
+            if (fromFirst[v] != unreachable && fromFirst[v] > fromFirst[next]) next = v;
+        }
+        while (count() < wanted && count() < numVertices) {
+            landmarks.push_back(next);
+            distances.push_back(shortestPaths(graph, next));
+            const vector<double>& latest = distances.back();
+            int farthest = -1;
+            for (int v = 1; v <= numVertices; ++v) {
+                if (latest[v] < closest[v]) closest[v] = latest[v];
+                bool chosen = find(landmarks.begin(), landmarks.end(), v) != landmarks.end();
+                if (!chosen && (farthest < 0 || closest[v] > closest[farthest])) farthest = v;
+            }
+            if (farthest < 0) break;
+            next = farthest;
+        }
+    }
+
+    bool load(const string& path, int vertices, uint64_t fingerprint, int wanted) {
+        ifstream in(path, ios::binary);
+        char magic[4];
+        uint32_t storedVertices, storedCount;
+        uint64_t storedFingerprint;
+        if (!in.read(magic, 4) || memcmp(magic, "LMK1", 4) != 0) return false;
+        in.read(reinterpret_cast<char*>(&storedVertices), sizeof(storedVertices));
+        in.read(reinterpret_cast<char*>(&storedCount), sizeof(storedCount));
+        in.read(reinterpret_cast<char*>(&storedFingerprint), sizeof(storedFingerprint));
+        if (!in || storedVertices != static_cast<uint32_t>(vertices) || storedFingerprint != fingerprint ||
+            storedCount != static_cast<uint32_t>(wanted)) {
+            return false;
+        }
+        numVertices = vertices;
+        landmarks.resize(storedCount);
+        distances.assign(storedCount, vector<double>(vertices + 1));
+        for (uint32_t l = 0; l < storedCount; ++l) {
+            in.read(reinterpret_cast<char*>(&landmarks[l]), sizeof(int));
+            in.read(reinterpret_cast<char*>(distances[l].data()), (vertices + 1) * sizeof(double));
+        }
+        return static_cast<bool>(in);
+    }
+
+    void save(const string& path, uint64_t fingerprint) const {
+        ofstream out(path, ios::binary);
+        uint32_t storedVertices = numVertices, storedCount = count();
+        out.write("LMK1", 4);
+        out.write(reinterpret_cast<const char*>(&storedVertices), sizeof(storedVertices));
+        out.write(reinterpret_cast<const char*>(&storedCount), sizeof(storedCount));
+        out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        for (int l = 0; l < count(); ++l) {
+            out.write(reinterpret_cast<const char*>(&landmarks[l]), sizeof(int));
+            out.write(reinterpret_cast<const char*>(distances[l].data()), (numVertices + 1) * sizeof(double));
+        }
+    }
+
+    // Landmarks that reach only one of v and t say nothing useful here: the
+    // search never crosses components, so they contribute 0.
+    double lowerBound(int v, int t) const {
+        const double unreachable = numeric_limits<double>::max();
+        double bound = 0;
+        for (const auto& row : distances) {
+            if (row[v] == unreachable || row[t] == unreachable) continue;
+            bound = max(bound, fabs(row[t] - row[v]));
+        }
+        return bound;
+    }
+};
+
+// Bidirectional Dijkstra, optionally guided by the average ALT potential
+// p(v) = (bound(v, t) - bound(s, v)) / 2, which keeps both directions
+// consistent. The search stops once the two smallest keys add up to the best
+// meeting distance found so far. State is reset only where it was touched, so
+// a query costs its search space rather than O(V). On graphs with fractional
+// weights, answers that truncate ambiguously are redone from s alone.
+class PointToPointSearch {
+private:
+    const Grafo& graph;
+    const Landmarks* landmarks;
+    bool fractional;
+    vector<double> distance[2];
+    vector<double> potential;
+    vector<int> touched;
+    DaryHeap queue[2];
+    int source;
+    int target;
+
+    double potentialOf(int v) {
+        if (!landmarks) return 0;
+        if (std::isnan(potential[v])) {
+            potential[v] = (landmarks->lowerBound(v, target) - landmarks->lowerBound(source, v)) / 2;
+        }
+        return potential[v];
+    }
+
+    double forwardDistance(long long& settled) {
+        const double unreachable = numeric_limits<double>::max();
+        for (int v : touched) {
+            distance[0][v] = distance[1][v] = unreachable;
+            potential[v] = nan("");
+        }
+        touched.clear();
+        queue[0].clear();
+        distance[0][source] = 0;
+        touched.push_back(source);
+        queue[0].update(source, unreachable, 0);
+        while (!queue[0].empty()) {
+            int current = queue[0].pop();
+            ++settled;
+            if (current == target) break;
+            NeighborSpan neighbors = graph.getNeighbors(current);
+            for (int e = 0; e < neighbors.size(); ++e) {
+                int next = neighbors.targets[e];
+                double candidate = distance[0][current] + neighbors.weights[e];
+                if (candidate < distance[0][next]) {
+                    if (distance[0][next] == unreachable) touched.push_back(next);
+                    queue[0].update(next, distance[0][next], candidate);
+                    distance[0][next] = candidate;
+                }
+            }
+        }
+        return distance[0][target];
+    }
+
+    void reach(int side, int v, double value) {
+        double previous = distance[side][v];
+        if (previous == numeric_limits<double>::max() && distance[1 - side][v] == numeric_limits<double>::max()) {
+            touched.push_back(v);
+        }
+        distance[side][v] = value;
+        double key = side == 0 ? value + potentialOf(v) : value - potentialOf(v);
+        queue[side].update(v, previous, key);
+    }
+
+public:
+    PointToPointSearch(const Grafo& g, const Landmarks* alt)
+        : graph(g), landmarks(alt), fractional(!g.hasIntegerWeights()), potential(g.getSize() + 1, nan("")),
+          queue{DaryHeap(g.getSize()), DaryHeap(g.getSize())}, source(0), target(0) {
+        distance[0].assign(g.getSize() + 1, numeric_limits<double>::max());
+        distance[1].assign(g.getSize() + 1, numeric_limits<double>::max());
+    }
+
+    double query(int s, int t, long long& settled) {
+        const double unreachable = numeric_limits<double>::max();
+        for (int v : touched) {
+            distance[0][v] = distance[1][v] = unreachable;
+            potential[v] = nan("");
+        }
+        touched.clear();
+        queue[0].clear();
+        queue[1].clear();
+        source = s;
+        target = t;
+        settled = 0;
+        if (s == t) return 0;
+
+        double best = unreachable;
+        reach(0, s, 0);
+        reach(1, t, 0);
+        while (!queue[0].empty() && !queue[1].empty()) {
+            if (best != unreachable && queue[0].topKey() + queue[1].topKey() >= best) break;
+            int side = queue[0].topKey() <= queue[1].topKey() ? 0 : 1;
+            int current = queue[side].pop();
+            ++settled;
+            NeighborSpan neighbors = graph.getNeighbors(current);
+            for (int e = 0; e < neighbors.size(); ++e) {
+                int next = neighbors.targets[e];
+                double candidate = distance[side][current] + neighbors.weights[e];
+                if (candidate < distance[side][next]) {
+                    reach(side, next, candidate);
+                    if (distance[1 - side][next] != unreachable) {
+                        best = min(best, candidate + distance[1 - side][next]);
+                    }
+                }
+            }
+        }
+        if (fractional && best != unreachable && truncationIsAmbiguous(best)) return forwardDistance(settled);
+        return best;
+    }
+};
+
+struct DijkstraOptions {
+    string sources;
+    string sourcesFile;
+    string queue;
+    string algorithm;
+    double delta;
+    string target;
+    string pairsFile;
+    string hierarchyFile;
+    string convertFile;
+    bool buildHierarchy;
+    bool echo;
+    int verifyPairs;
+    int landmarks;
+    int threads;
+    DijkstraOptions()
+        : sources("1"), queue("dary"), algorithm("dijkstra"), delta(0), buildHierarchy(false), echo(false), verifyPairs(0),
+          landmarks(0), threads(1) {}
+};
+
+// The console line keeps its historical double spacing; the file does not.
+// console is null unless the output is echoed.
+void appendDistanceLine(string* console, string& file, const vector<double>& distances, int vertices) {
+    for (int i = 1; i <= vertices; ++i) {
+        size_t fileStart = file.size();
+        appendInteger(file, i);
+        file += ':';
+        if (distances[i] == numeric_limits<double>::max()) {
+            file += "-1";
+        } else {
+            appendInteger(file, static_cast<int>(distances[i]));
+        }
+        if (console) {
+            console->append(file, fileStart, string::npos);
+            *console += i < vertices ? "  " : " ";
+        }
+        if (i < vertices) file += ' ';
+    }
+    if (console) *console += '\n';
+    file += '\n';
+}
+
+// Accepts "all", a single vertex, ranges such as "10-20" and comma-separated
+// mixes of both ("1,4-6,9").
+bool parseSources(const string& spec, int vertices, vector<int>& sources) {
+    if (spec == "all") {
+        for (int v = 1; v <= vertices; ++v) sources.push_back(v);
+        return true;
+    }
+    stringstream items(spec);
+    string item;
+    while (getline(items, item, ',')) {
+        size_t dash = item.find('-', 1);
+        int first = 0, last = 0;
+        try {
+            first = stoi(item.substr(0, dash));
+            last = dash == string::npos ? first : stoi(item.substr(dash + 1));
+        } catch (const exception&) {
+            cerr << "Erro: lista de vértices iniciais inválida: " << spec << endl;
+            return false;
+        }
+        if (first < 1 || last > vertices || first > last) {
+            cerr << "Erro: vértice inicial inválido: " << item << endl;
+            return false;
+        }
+        for (int v = first; v <= last; ++v) sources.push_back(v);
+    }
+    return true;
+}
+
+// Each pool lane owns one distance buffer and one queue and pulls sources from
+// a shared counter. Lines are produced a block at a time so the output keeps
+// the source order without holding every line in memory.
+template <typename Queue>
+void runSources(const Grafo& graph, const vector<int>& sources, int threads, OutputWriter& out, OutputWriter* console) {
+    WorkerPool pool(threads);
+    int vertices = graph.getSize();
+    vector<vector<double>> distances(pool.size(), vector<double>(vertices + 1, numeric_limits<double>::max()));
+    vector<Queue> queues(pool.size(), Queue(vertices));
+
+    size_t lineBytes = static_cast<size_t>(vertices) * 12 + 1;
+    size_t blockSize = max<size_t>(pool.size(), min<size_t>(4096, (size_t(64) << 20) / lineBytes));
+    vector<string> consoleLines, fileLines;
+    for (size_t blockStart = 0; blockStart < sources.size(); blockStart += blockSize) {
+        size_t blockEnd = min(sources.size(), blockStart + blockSize);
+        consoleLines.assign(blockEnd - blockStart, string());
+        fileLines.assign(blockEnd - blockStart, string());
+        atomic<size_t> nextSource(blockStart);
+        pool.parallelFor(pool.size(), [&](int lane) {
+            for (size_t k = nextSource++; k < blockEnd; k = nextSource++) {
+                vector<double>& laneDistances = distances[lane];
+                fill(laneDistances.begin(), laneDistances.end(), numeric_limits<double>::max());
+                queues[lane].clear();
+                shortestPathsInto(graph, sources[k], laneDistances, queues[lane], nullptr);
+                appendDistanceLine(console ? &consoleLines[k - blockStart] : nullptr, fileLines[k - blockStart],
+                                   laneDistances, vertices);
+            }
+        });
+        for (size_t k = 0; k < fileLines.size(); ++k) {
+            if (console) console->put(consoleLines[k]);
+            out.put(fileLines[k]);
+        }
+    }
+}
+
+// One source at a time with every thread inside the search, for graphs where
+// a single source is already too slow on one core.
+void runDeltaSources(const Grafo& graph, const vector<int>& sources, int threads, double delta, OutputWriter& out,
+                     OutputWriter* console) {
+    WorkerPool pool(threads);
+    DeltaStepping<Grafo> engine(graph, pool, delta);
+    vector<double> distances;
+    string consoleLine, fileLine;
+    for (int source : sources) {
+        engine.run(source, distances);
+        consoleLine.clear();
+        fileLine.clear();
+        appendDistanceLine(console ? &consoleLine : nullptr, fileLine, distances, graph.getSize());
+        if (console) console->put(consoleLine);
+        out.put(fileLine);
+    }
+}
+
+// Lanes of the pool answer pairs independently, each with its own Search
+// (anything with query(s, t, settled)); lines keep the input order.
+template <typename Search>
+void runPairs(vector<Search>& searches, WorkerPool& pool, int vertices, const vector<pair<int, int>>& pairs,
+              OutputWriter& out) {
+    vector<string> lines(pairs.size());
+    vector<long long> settled(pairs.size());
+    atomic<size_t> nextPair(0);
+    auto start = chrono::steady_clock::now();
+    pool.parallelFor(pool.size(), [&](int lane) {
+        for (size_t k = nextPair++; k < pairs.size(); k = nextPair++) {
+            double distance = searches[lane].query(pairs[k].first, pairs[k].second, settled[k]);
+            string& line = lines[k];
+            appendInteger(line, pairs[k].first);
+            line += "->";
+            appendInteger(line, pairs[k].second);
+            line += ": ";
+            appendInteger(line, distance == numeric_limits<double>::max() ? -1 : static_cast<int>(distance));
+            line += " (vértices fixados: ";
+            appendInteger(line, settled[k]);
+            line += " de ";
+            appendInteger(line, vertices);
+            line += ")\n";
+        }
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long totalSettled = 0;
+    for (size_t k = 0; k < pairs.size(); ++k) {
+        out.put(lines[k]);
+        totalSettled += settled[k];
+    }
+    out.flush();
+    if (!pairs.empty()) {
+        cerr << pairs.size() << " consultas, média de " << static_cast<double>(totalSettled) / pairs.size()
+             << " vértices fixados por consulta (" << vertices << " numa busca completa), "
+             << seconds * 1e6 / pairs.size() << " µs por consulta" << endl;
+    }
+}
+
+bool readPairs(const DijkstraOptions& options, int vertices, vector<pair<int, int>>& pairs) {
+    if (!options.pairsFile.empty()) {
+        ifstream pairsIn(options.pairsFile);
+        if (!pairsIn) {
+            cerr << "Erro: Nao foi possivel abrir o arquivo de pares " << options.pairsFile << endl;
+            return false;
+        }
+        int s, t;
+        while (pairsIn >> s >> t) pairs.emplace_back(s, t);
+    } else {
+        try {
+            pairs.emplace_back(stoi(options.sources), stoi(options.target));
+        } catch (const exception&) {
+            cerr << "Erro: -t exige um único vértice inicial e um destino." << endl;
+            return false;
+        }
+    }
+    for (const auto& query : pairs) {
+        if (query.first < 1 || query.second < 1 || query.first > vertices || query.second > vertices) {
+            cerr << "Erro: par inválido: " << query.first << " " << query.second << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Query mode over a saved index: the graph file is not needed.
+void runHierarchyQueries(const DijkstraOptions& options, const string& outputFile) {
+    ContractionHierarchy hierarchy;
+    if (!hierarchy.load(options.hierarchyFile)) {
+        cerr << "Erro: índice de hierarquia inválido " << options.hierarchyFile << endl;
+        return;
+    }
+    vector<pair<int, int>> pairs;
+    if (!readPairs(options, hierarchy.getSize(), pairs)) return;
+    ofstream outFile(outputFile);
+    OutputWriter out(&outFile, options.echo);
+    WorkerPool pool(options.threads);
+    vector<ContractionHierarchyQuery> searches(pool.size(), ContractionHierarchyQuery(hierarchy));
+    runPairs(searches, pool, hierarchy.getSize(), pairs, out);
+}
+
+// Compares the hierarchy with shortestPaths on random pairs; a few sources
+// with many targets each keep the reference runs affordable.
+bool verifyHierarchy(const Grafo& graph, const ContractionHierarchy& hierarchy, int pairCount) {
+    mt19937 random(7);
+    uniform_int_distribution<int> vertex(1, graph.getSize());
+    ContractionHierarchyQuery search(hierarchy);
+    int mismatches = 0;
+    for (int checked = 0; checked < pairCount;) {
+        int source = vertex(random);
+        vector<double> reference = shortestPaths(graph, source);
+        for (int k = 0; k < 100 && checked < pairCount; ++k, ++checked) {
+            int target = vertex(random);
+            long long settled;
+            double answer = search.query(source, target, settled);
+            double expected = reference[target];
+            bool same = answer == expected ||
+                        (expected != numeric_limits<double>::max() && fabs(answer - expected) <= 1e-9 * max(1.0, expected));
+            if (!same) {
+                if (mismatches < 10) {
+                    cerr << "Divergência " << source << "->" << target << ": hierarquia " << answer << ", Dijkstra "
+                         << expected << endl;
+                }
+                ++mismatches;
+            }
+        }
+    }
+    cout << "Verificação da hierarquia: " << pairCount << " pares, " << mismatches << " divergências" << endl;
+    return mismatches == 0;
+}
+
 void displayHelp() {
     cout << "-h : exibe esta mensagem de ajuda" << endl;
     cout << "-o <arquivo> : redireciona a saída para o arquivo especificado" << endl;
+    cout << "--echo : repete a saída no console (por padrão ela só vai para o arquivo)" << endl;
     cout << "-f <arquivo> : especifica o arquivo de entrada com o grafo" << endl;
-    cout << "-i <numero> : define o vértice inicial" << endl;
+    cout << "-i <vertices> : vértice(s) inicial(is): um número, uma faixa (1-100), uma lista (1,5,9) ou all" << endl;
+    cout << "--sources <arquivo> : lê os vértices iniciais do arquivo; uma linha de saída por vértice" << endl;
+    cout << "--threads <n> : número de threads para várias origens (0 usa todos os núcleos)" << endl;
+    cout << "-t <destino> : distância de -i até o destino por Dijkstra bidirecional" << endl;
+    cout << "--pairs <arquivo> : responde os pares \"s t\" do arquivo, um por linha" << endl;
+    cout << "--alt <k> : usa A* com k landmarks (ALT), salvos em <grafo>.landmarks" << endl;
+    cout << "--ch-build <índice> : contrai o grafo numa hierarquia e grava o índice" << endl;
+    cout << "--ch <índice> : responde -i/-t ou --pairs pelo índice, sem ler o grafo" << endl;
+    cout << "--ch-verify <n> : confere n pares aleatórios da hierarquia contra shortestPaths" << endl;
+    cout << "--pq <set|dary|radix|pairing> : fila de prioridade (padrão dary; radix exige pesos inteiros não negativos)" << endl;
+    cout << "--algo <dijkstra|delta> : delta usa delta-stepping paralelo em cada origem, com --threads" << endl;
+    cout << "--delta <largura> : largura dos baldes do delta-stepping (padrão: escolhida pelos pesos)" << endl;
+    cout << "--bench <vertices> <arestas> : mede cada fila e a aceleração do delta-stepping com 1 a 16 threads" << endl;
+    cout << "--convert <snapshot> : grava o grafo lido num snapshot binário (CSR não direcionado), aceito por -f" << endl;
+    cout << "--parse-bench <arquivo> : mede a leitura em MB/s: ifstream, mmap com 1 thread e com --threads (padrão: todos)"
+         << endl;
 }
 
-void processFile(const string& inputFile, const string& outputFile, int startVertex) {
-    ifstream inFile(inputFile);
-    ofstream outFile(outputFile);
+void runBenchmark(int vertices, long long edges) {
+    mt19937 random(42);
+    uniform_int_distribution<int> vertex(1, vertices);
+    uniform_int_distribution<int> weight(1, 1000);
+
+    auto start = chrono::steady_clock::now();
+    Grafo graph(vertices);
+    for (long long i = 0; i < edges; ++i) {
+        graph.addEdge(vertex(random), vertex(random), weight(random));
+    }
+    graph.freeze();
+    double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Grafo: " << vertices << " vértices, " << graph.getEdgeCount() << " arestas (montagem em "
+         << buildSeconds << " s)" << endl;
+
+    const char* queues[] = {"set", "dary", "radix", "pairing"};
+    for (const char* queue : queues) {
+        long long operations = 0;
+        start = chrono::steady_clock::now();
+        vector<double> distances = shortestPaths(graph, 1, queue, &operations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        long long settled = 0;
+        for (int i = 1; i <= vertices; ++i) {
+            if (distances[i] != numeric_limits<double>::max()) ++settled;
+        }
+        cout << queue << ": " << seconds << " s, " << settled / seconds << " vértices fixados/s, "
+             << operations / seconds << " operações de fila/s" << endl;
+    }
 
-    if (!inFile) {
+    vector<double> reference = shortestPaths(graph, 1);
+    double baseline = 0;
+    const int threadCounts[] = {1, 2, 4, 8, 16};
+    for (int threads : threadCounts) {
+        WorkerPool pool(threads);
+        DeltaStepping<Grafo> engine(graph, pool, 0);
+        vector<double> distances;
+        start = chrono::steady_clock::now();
+        engine.run(1, distances);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (threads == 1) baseline = seconds;
+        cout << "delta (" << threads << " threads, largura " << engine.getDelta() << "): " << seconds
+             << " s, aceleração " << baseline / seconds << "x, "
+             << (distances == reference ? "igual ao dary" : "DIFERENTE do dary") << endl;
+    }
+}
+
+void processFile(const string& inputFile, const string& outputFile, DijkstraOptions options) {
+    GraphFileReader inFile;
+    GraphSnapshot snapshot;
+
+    bool fromSnapshot = GraphSnapshot::isSnapshot(inputFile);
+    if (fromSnapshot ? !snapshot.open(inputFile) : !inFile.open(inputFile)) {
         cerr << "Erro: Nao foi possivel abrir o arquivo de entrada " << inputFile << endl;
         return;
     }
+    if (fromSnapshot && !options.convertFile.empty()) {
+        cerr << "Erro: a entrada já é um snapshot" << endl;
+        return;
+    }
 
-    string header;
-    while (getline(inFile, header) && header.find("%%") != string::npos);
+    int vertices = 0, edges = 0;
+    if (fromSnapshot) {
+        vertices = snapshot.vertices();
+    } else {
+        string header;
+        while (inFile.readLine(header) && header.find("%%") != string::npos);
 
-    stringstream ss(header);
-    int vertices, edges;
-    ss >> vertices >> edges;
+        stringstream ss(header);
+        ss >> vertices >> edges;
+    }
+
+    if (!options.convertFile.empty()) {
+        EdgeRecords<double> records;
+        inFile.readEdges(edges, EdgeWeight::WhenInRange, vertices, options.threads, records);
+        string error;
+        if (!writeGraphSnapshot(options.convertFile, vertices, records.from, records.to, &records.weight, false,
+                                error)) {
+            cerr << "Erro: Nao foi possivel gravar o snapshot " << options.convertFile << ": " << error << endl;
+        }
+        return;
+    }
 
+    ofstream outFile(outputFile);
     Grafo graph(vertices);
+    if (fromSnapshot) {
+        if (!graph.attach(snapshot)) {
+            cerr << "Erro: pesos do snapshot não representáveis " << inputFile << endl;
+            return;
+        }
+    } else {
+        EdgeRecords<double> records;
+        inFile.readEdges(edges, EdgeWeight::WhenInRange, vertices, options.threads, records);
+        graph.adoptEdges(records);
+        graph.freeze();
+    }
 
-    for (int i = 0; i < edges; ++i) {
-        int u, v;
-        double w = 1.0;
-        if (!(inFile >> u >> v) || u < 1 || v < 1 || u > vertices || v > vertices) continue;
-        inFile >> w;
-        graph.addEdge(u, v, w);
+    if (options.buildHierarchy || options.verifyPairs > 0) {
+        if (graph.hasNegativeWeights()) {
+            cerr << "Erro: a hierarquia exige pesos não negativos." << endl;
+            return;
+        }
+        ContractionHierarchy hierarchy;
+        if (options.buildHierarchy) {
+            auto start = chrono::steady_clock::now();
+            hierarchy.build(graph);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (!hierarchy.save(options.hierarchyFile)) {
+                cerr << "Erro: Nao foi possivel gravar o índice " << options.hierarchyFile << endl;
+                return;
+            }
+            cout << "Hierarquia: " << vertices << " vértices, " << hierarchy.getUpwardEdgeCount()
+                 << " arestas para cima, núcleo não contraído de " << hierarchy.getCoreSize()
+                 << " vértices, construída em " << seconds << " s" << endl;
+        } else if (!hierarchy.load(options.hierarchyFile) || hierarchy.getSize() != vertices) {
+            cerr << "Erro: índice de hierarquia inválido para este grafo " << options.hierarchyFile << endl;
+            return;
+        }
+        if (options.verifyPairs > 0) verifyHierarchy(graph, hierarchy, options.verifyPairs);
+        return;
     }
 
-    vector<double> distances = shortestPaths(graph, startVertex);
+    if (!options.target.empty() || !options.pairsFile.empty()) {
+        vector<pair<int, int>> pairs;
+        if (!readPairs(options, vertices, pairs)) return;
 
-    for (int i = 1; i <= vertices; ++i) {
-        if (distances[i] == numeric_limits<double>::max()) {
-            cout << i << ":-1 ";
-            outFile << i << ":" << -1;
-        } else {
-            cout << i << ":" << static_cast<int>(distances[i]) << " ";
-            outFile << i << ":" << static_cast<int>(distances[i]);
+        Landmarks landmarks;
+        if (options.landmarks > 0) {
+            string path = inputFile + ".landmarks";
+            if (!landmarks.load(path, vertices, graph.fingerprint(), options.landmarks)) {
+                landmarks.select(graph, options.landmarks);
+                landmarks.save(path, graph.fingerprint());
+            }
+        }
+        WorkerPool pool(options.threads);
+        vector<PointToPointSearch> searches(pool.size(), PointToPointSearch(graph, options.landmarks > 0 ? &landmarks : nullptr));
+        OutputWriter out(&outFile, options.echo);
+        runPairs(searches, pool, vertices, pairs, out);
+        return;
+    }
+
+    vector<int> sources;
+    if (!options.sourcesFile.empty()) {
+        ifstream sourcesIn(options.sourcesFile);
+        if (!sourcesIn) {
+            cerr << "Erro: Nao foi possivel abrir o arquivo de origens " << options.sourcesFile << endl;
+            return;
         }
-        if (i < vertices) {
-            cout << " ";
-            outFile << " ";
+        int source;
+        while (sourcesIn >> source) {
+            if (source < 1 || source > vertices) {
+                cerr << "Erro: vértice inicial inválido: " << source << endl;
+                return;
+            }
+            sources.push_back(source);
         }
+    } else if (!parseSources(options.sources, vertices, sources)) {
+        return;
+    }
+
+    OutputWriter out(&outFile, false);
+    OutputWriter console(nullptr, options.echo);
+    OutputWriter* echo = options.echo ? &console : nullptr;
+    if (options.algorithm == "delta") {
+        if (graph.hasNegativeWeights()) {
+            cerr << "Aviso: delta-stepping exige pesos não negativos, usando dijkstra." << endl;
+        } else {
+            runDeltaSources(graph, sources, options.threads, options.delta, out, echo);
+            return;
+        }
+    }
+
+    if (options.queue == "radix" && !graph.hasIntegerWeights()) {
+        cerr << "Aviso: radix exige pesos inteiros não negativos, usando dary." << endl;
+        options.queue = "dary";
+    }
+    if (options.queue == "set") {
+        runSources<SetQueue>(graph, sources, options.threads, out, echo);
+    } else if (options.queue == "radix") {
+        runSources<RadixHeap>(graph, sources, options.threads, out, echo);
+    } else if (options.queue == "pairing") {
+        runSources<PairingHeap>(graph, sources, options.threads, out, echo);
+    } else {
+        runSources<DaryHeap>(graph, sources, options.threads, out, echo);
     }
-    cout << endl;
-    outFile << endl;
 
     inFile.close();
-    outFile.close();
+}
+
+// The ifstream loop processFile used before GraphFileReader, kept as the
+// baseline for --parse-bench.
+void readWithStream(const string& path, EdgeRecords<double>& records) {
+    ifstream inFile(path);
+    string header;
+    while (getline(inFile, header) && header.find("%%") != string::npos);
+    stringstream ss(header);
+    int vertices = 0, edges = 0;
+    ss >> vertices >> edges;
+    for (int i = 0; i < edges; ++i) {
+        int u, v;
+        double w = 1.0;
+        if (!(inFile >> u >> v)) break;
+        if (u >= 1 && v >= 1 && u <= vertices && v <= vertices) inFile >> w;
+        records.from.push_back(u);
+        records.to.push_back(v);
+        records.weight.push_back(w);
+    }
+}
+
+void runParseBenchmark(const string& path, int threads) {
+    auto start = chrono::steady_clock::now();
+    EdgeRecords<double> reference;
+    readWithStream(path, reference);
+    double baseline = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    GraphFileReader probe;
+    if (!probe.open(path)) {
+        cerr << "Erro: Nao foi possivel abrir o arquivo de entrada " << path << endl;
+        return;
+    }
+    double megabytes = probe.size() / 1048576.0;
+    cout << "Arquivo: " << megabytes << " MB, " << reference.size() << " arestas" << endl;
+    cout << "ifstream: " << baseline << " s, " << megabytes / baseline << " MB/s" << endl;
+
+    vector<int> laneCounts(1, 1);
+    if (threads != 1) laneCounts.push_back(threads);
+    for (int lanes : laneCounts) {
+        start = chrono::steady_clock::now();
+        GraphFileReader reader;
+        reader.open(path);
+        string header;
+        while (reader.readLine(header) && header.find("%%") != string::npos);
+        stringstream ss(header);
+        int vertices = 0, edges = 0;
+        ss >> vertices >> edges;
+        EdgeRecords<double> records;
+        reader.readEdges(edges, EdgeWeight::WhenInRange, vertices, lanes, records);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        bool same = records.from == reference.from && records.to == reference.to && records.weight == reference.weight;
+        string label = lanes == 0 ? "todos os núcleos" : to_string(lanes) + (lanes == 1 ? " thread" : " threads");
+        cout << "mmap (" << label << "): " << seconds << " s, " << megabytes / seconds << " MB/s, " << baseline / seconds << "x, "
+             << (same ? "igual ao ifstream" : "DIFERENTE do ifstream") << endl;
+    }
 }
 
 int main(int argc, char* argv[]) {
     string inputFile, outputFile = "saida.txt";
-    int startVertex = 1;
+    DijkstraOptions options;
+    string parseBenchFile;
 
     for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--bench" && i + 2 < argc) {
+            runBenchmark(stoi(argv[i + 1]), stoll(argv[i + 2]));
+            return 0;
+        }
+        if (string(argv[i]) == "--parse-bench" && i + 1 < argc) {
+            parseBenchFile = argv[++i];
+            continue;
+        }
+        if (string(argv[i]) == "--pq" && i + 1 < argc) {
+            options.queue = argv[++i];
+            if (options.queue != "set" && options.queue != "dary" && options.queue != "radix" &&
+                options.queue != "pairing") {
+                cerr << "Erro: fila de prioridade desconhecida " << options.queue << endl;
+                return 1;
+            }
+            continue;
+        }
+        if (string(argv[i]) == "--algo" && i + 1 < argc) {
+            options.algorithm = argv[++i];
+            if (options.algorithm != "dijkstra" && options.algorithm != "delta") {
+                cerr << "Erro: algoritmo desconhecido " << options.algorithm << endl;
+                return 1;
+            }
+            continue;
+        }
+        if (string(argv[i]) == "--delta" && i + 1 < argc) {
+            options.delta = stod(argv[++i]);
+            continue;
+        }
+        if (string(argv[i]) == "--sources" && i + 1 < argc) {
+            options.sourcesFile = argv[++i];
+            continue;
+        }
+        if (string(argv[i]) == "--threads" && i + 1 < argc) {
+            options.threads = stoi(argv[++i]);
+            continue;
+        }
+        if (string(argv[i]) == "--pairs" && i + 1 < argc) {
+            options.pairsFile = argv[++i];
+            continue;
+        }
+        if (string(argv[i]) == "--ch-build" && i + 1 < argc) {
+            options.hierarchyFile = argv[++i];
+            options.buildHierarchy = true;
+            continue;
+        }
+        if (string(argv[i]) == "--ch" && i + 1 < argc) {
+            options.hierarchyFile = argv[++i];
+            continue;
+        }
+        if (string(argv[i]) == "--echo") {
+            options.echo = true;
+            continue;
+        }
+        if (string(argv[i]) == "--convert" && i + 1 < argc) {
+            options.convertFile = argv[++i];
+            continue;
+        }
+        if (string(argv[i]) == "--ch-verify" && i + 1 < argc) {
+            options.verifyPairs = stoi(argv[++i]);
+            continue;
+        }
+        if (string(argv[i]) == "--alt" && i + 1 < argc) {
+            options.landmarks = stoi(argv[++i]);
+            continue;
+        }
         if (argv[i][0] == '-' && i + 1 < argc) {
             if (argv[i][1] == 'o') outputFile = argv[++i];
             else if (argv[i][1] == 'f') inputFile = argv[++i];
-            else if (argv[i][1] == 'i') startVertex = stoi(argv[++i]);
+            else if (argv[i][1] == 'i') options.sources = argv[++i];
+            else if (argv[i][1] == 't') options.target = argv[++i];
             else if (argv[i][1] == 'h') {
                 displayHelp();
                 return 0;
@@ -129,11 +1015,21 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!parseBenchFile.empty()) {
+        runParseBenchmark(parseBenchFile, options.threads == 1 ? 0 : options.threads);
+        return 0;
+    }
+
+    if (!options.hierarchyFile.empty() && !options.buildHierarchy && options.verifyPairs == 0) {
+        runHierarchyQueries(options, outputFile);
+        return 0;
+    }
+
     if (inputFile.empty()) {
         cerr << "Erro: Nenhum arquivo de entrada especificado." << endl;
         return 1;
     }
 
-    processFile(inputFile, outputFile, startVertex);
+    processFile(inputFile, outputFile, options);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#ifndef GRAFOS_PRIORITY_QUEUES_H
+#define GRAFOS_PRIORITY_QUEUES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Every backend exposes the same operations used by shortestPaths:
+// update(v, oldKey, newKey) inserts v or lowers its key (oldKey is the
+// previous tentative distance, max() when v is not queued), pop() removes
+// a vertex of minimum key, empty(), and clear() so that one queue can be
+// reused across sources.
+
+class SetQueue {
+private:
+    std::set<std::pair<double, int>> entries;
+
+public:
+    explicit SetQueue(int) {}
+
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+
+    void update(int vertex, double oldKey, double newKey) {
+        entries.erase(std::make_pair(oldKey, vertex));
+        entries.insert(std::make_pair(newKey, vertex));
+    }
+
+    int pop() {
+        int vertex = entries.begin()->second;
+        entries.erase(entries.begin());
+        return vertex;
+    }
+};
+
+// Indexed 4-ary min-heap: position[v] locates v in the heap, so lowering a
+// key is a sift-up instead of a delete plus insert.
+class DaryHeap {
+private:
+    static const int ARITY = 4;
+    std::vector<int> heap;
+    std::vector<int> position;
+    std::vector<double> key;
+
+    void place(int index, int vertex) {
+        heap[index] = vertex;
+        position[vertex] = index;
+    }
+
+    void siftUp(int index) {
+        int vertex = heap[index];
+        while (index > 0) {
+            int parent = (index - 1) / ARITY;
+            if (key[heap[parent]] <= key[vertex]) break;
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, vertex);
+    }
+
+    void siftDown(int index) {
+        int vertex = heap[index];
+        int size = static_cast<int>(heap.size());
+        while (true) {
+            int first = index * ARITY + 1;
+            if (first >= size) break;
+            int best = first;
+            int last = std::min(first + ARITY, size);
+            for (int child = first + 1; child < last; ++child) {
+                if (key[heap[child]] < key[heap[best]]) best = child;
+            }
+            if (key[vertex] <= key[heap[best]]) break;
+            place(index, heap[best]);
+            index = best;
+        }
+        place(index, vertex);
+    }
+
+public:
+    explicit DaryHeap(int vertices) : position(vertices + 1, -1), key(vertices + 1) {}
+
+    bool empty() const { return heap.empty(); }
+    double topKey() const { return key[heap[0]]; }
+
+    void clear() {
+        for (int vertex : heap) position[vertex] = -1;
+        heap.clear();
+    }
+
+    void update(int vertex, double, double newKey) {
+        key[vertex] = newKey;
+        if (position[vertex] < 0) {
+            heap.push_back(vertex);
+            siftUp(static_cast<int>(heap.size()) - 1);
+        } else {
+            siftUp(position[vertex]);
+        }
+    }
+
+    int pop() {
+        int top = heap[0];
+        position[top] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            place(0, last);
+            siftDown(0);
+        }
+        return top;
+    }
+};
+
+// Monotone radix heap for non-negative integer keys. Bucket b holds keys
+// whose highest bit differing from the last popped key is bit b - 1; a
+// lowered key is pushed again and the stale copy is skipped on pop.
+class RadixHeap {
+private:
+    std::vector<std::pair<uint64_t, int>> buckets[65];
+    std::vector<uint64_t> current;
+    std::vector<char> queued;
+    uint64_t last;
+    size_t live;
+
+    int bucketOf(uint64_t value) const { return value == last ? 0 : 64 - __builtin_clzll(value ^ last); }
+
+    bool stale(const std::pair<uint64_t, int>& entry) const {
+        return !queued[entry.second] || current[entry.second] != entry.first;
+    }
+
+public:
+    explicit RadixHeap(int vertices) : current(vertices + 1), queued(vertices + 1, 0), last(0), live(0) {}
+
+    bool empty() const { return live == 0; }
+
+    void clear() {
+        for (auto& bucket : buckets) {
+            for (const auto& entry : bucket) queued[entry.second] = 0;
+            bucket.clear();
+        }
+        last = 0;
+        live = 0;
+    }
+
+    void update(int vertex, double, double newKey) {
+        uint64_t value = static_cast<uint64_t>(newKey);
+        if (!queued[vertex]) ++live;
+        queued[vertex] = 1;
+        current[vertex] = value;
+        buckets[bucketOf(value)].push_back(std::make_pair(value, vertex));
+    }
+
+    int pop() {
+        while (true) {
+            while (!buckets[0].empty()) {
+                std::pair<uint64_t, int> entry = buckets[0].back();
+                buckets[0].pop_back();
+                if (stale(entry)) continue;
+                queued[entry.second] = 0;
+                --live;
+                return entry.second;
+            }
+            int b = 1;
+            while (buckets[b].empty()) ++b;
+            uint64_t smallest = std::numeric_limits<uint64_t>::max();
+            for (const auto& entry : buckets[b]) {
+                if (!stale(entry) && entry.first < smallest) smallest = entry.first;
+            }
+            std::vector<std::pair<uint64_t, int>> moved;
+            moved.swap(buckets[b]);
+            if (smallest == std::numeric_limits<uint64_t>::max()) continue;
+            last = smallest;
+            for (const auto& entry : moved) {
+                if (!stale(entry)) buckets[bucketOf(entry.first)].push_back(entry);
+            }
+        }
+    }
+};
+
+// Pairing heap with one preallocated node per vertex. prev points to the
+// left sibling, or to the parent for a leftmost child, so a node can be cut
+// out in O(1) when its key drops.
+class PairingHeap {
+private:
+    std::vector<int> child;
+    std::vector<int> sibling;
+    std::vector<int> prev;
+    std::vector<double> key;
+    std::vector<char> queued;
+    std::vector<int> pairs;
+    int root;
+
+    int meld(int a, int b) {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        if (key[b] < key[a]) std::swap(a, b);
+        sibling[b] = child[a];
+        if (child[a] >= 0) prev[child[a]] = b;
+        prev[b] = a;
+        child[a] = b;
+        sibling[a] = -1;
+        prev[a] = -1;
+        return a;
+    }
+
+    void cut(int node) {
+        if (child[prev[node]] == node) {
+            child[prev[node]] = sibling[node];
+        } else {
+            sibling[prev[node]] = sibling[node];
+        }
+        if (sibling[node] >= 0) prev[sibling[node]] = prev[node];
+        sibling[node] = -1;
+        prev[node] = -1;
+    }
+
+public:
+    explicit PairingHeap(int vertices)
+        : child(vertices + 1, -1), sibling(vertices + 1, -1), prev(vertices + 1, -1), key(vertices + 1),
+          queued(vertices + 1, 0), root(-1) {}
+
+    bool empty() const { return root < 0; }
+
+    void clear() {
+        while (root >= 0) pop();
+    }
+
+    void update(int vertex, double, double newKey) {
+        key[vertex] = newKey;
+        if (!queued[vertex]) {
+            queued[vertex] = 1;
+            child[vertex] = sibling[vertex] = prev[vertex] = -1;
+            root = meld(root, vertex);
+        } else if (vertex != root) {
+            cut(vertex);
+            root = meld(root, vertex);
+        }
+    }
+
+    int pop() {
+        int top = root;
+        queued[top] = 0;
+        pairs.clear();
+        for (int node = child[top]; node >= 0;) {
+            int first = node;
+            int second = sibling[first];
+            node = second >= 0 ? sibling[second] : -1;
+            sibling[first] = prev[first] = -1;
+            if (second >= 0) sibling[second] = prev[second] = -1;
+            pairs.push_back(meld(first, second));
+        }
+        root = -1;
+        for (size_t i = pairs.size(); i > 0; --i) {
+            root = meld(pairs[i - 1], root);
+        }
+        return top;
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef GRAFOS_APSP_FORMAT_H
+#define GRAFOS_APSP_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Layout of "--format bin": this header, then the V*V row-major distance
+// matrix (distanceBytes per cell: 2, 4 or 8) at distanceOffset and, when
+// APSP_HAS_NEXT is set, the V*V int32 successor matrix at nextOffset.
+// Unreachable pairs hold `infinity`, the largest value of the cell type.
+const char APSP_MAGIC[4] = {'A', 'P', 'S', 'P'};
+const uint32_t APSP_VERSION = 1;
+const uint32_t APSP_HAS_NEXT = 1;
+
+struct ApspFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertices;
+    uint32_t flags;
+    uint32_t distanceBytes;
+    uint32_t padding;
+    int64_t infinity;
+    uint64_t distanceOffset;
+    uint64_t nextOffset;
+    uint64_t reserved[2];
+};
+
+class ApspMatrixView {
+private:
+    void* mapping;
+    size_t mappingSize;
+    const ApspFileHeader* header;
+    const char* distances;
+    const int32_t* successors;
+
+public:
+    ApspMatrixView() : mapping(MAP_FAILED), mappingSize(0), header(nullptr), distances(nullptr), successors(nullptr) {}
+
+    ~ApspMatrixView() {
+        if (mapping != MAP_FAILED) munmap(mapping, mappingSize);
+    }
+
+    bool open(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ApspFileHeader)) {
+            close(fd);
+            return false;
+        }
+        mappingSize = static_cast<size_t>(info.st_size);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) return false;
+
+        header = static_cast<const ApspFileHeader*>(mapping);
+        uint64_t cells = static_cast<uint64_t>(header->vertices) * header->vertices;
+        uint32_t width = header->distanceBytes;
+        if (std::memcmp(header->magic, APSP_MAGIC, 4) != 0 || header->version != APSP_VERSION ||
+            (width != 2 && width != 4 && width != 8) || header->distanceOffset + cells * width > mappingSize) {
+            return false;
+        }
+        const char* base = static_cast<const char*>(mapping);
+        distances = base + header->distanceOffset;
+        if (header->flags & APSP_HAS_NEXT) {
+            if (header->nextOffset + cells * sizeof(int32_t) > mappingSize) return false;
+            successors = reinterpret_cast<const int32_t*>(base + header->nextOffset);
+        }
+        return true;
+    }
+
+    int vertices() const { return static_cast<int>(header->vertices); }
+    int64_t infinity() const { return header->infinity; }
+    bool hasPaths() const { return successors != nullptr; }
+
+    int64_t distance(int u, int v) const {
+        size_t cell = static_cast<size_t>(u) * header->vertices + v;
+        switch (header->distanceBytes) {
+            case 2: return reinterpret_cast<const int16_t*>(distances)[cell];
+            case 4: return reinterpret_cast<const int32_t*>(distances)[cell];
+            default: return reinterpret_cast<const int64_t*>(distances)[cell];
+        }
+    }
+    int32_t next(int u, int v) const { return successors[static_cast<size_t>(u) * header->vertices + v]; }
+};
+
+#endif
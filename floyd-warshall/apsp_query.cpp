@@ -0,0 +1,86 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+
+#include "apsp_format.h"
+
+void displayHelp() {
+    std::cout << "-h : mostra o help\n";
+    std::cout << "-f <arquivo> : matriz gerada por floyd.bin --format bin\n";
+    std::cout << "-q <arquivo> : pares \"u v\" a consultar (padrão: entrada padrão)\n";
+}
+
+void answer(const ApspMatrixView& matrix, long u, long v) {
+    std::cout << (matrix.hasPaths() ? "Caminho " : "Distância ") << u << "->" << v << ": ";
+    if (u < 1 || v < 1 || u > matrix.vertices() || v > matrix.vertices()) {
+        std::cout << "vértice inválido\n";
+        return;
+    }
+    int from = static_cast<int>(u) - 1, to = static_cast<int>(v) - 1;
+    int64_t distance = matrix.distance(from, to);
+    if (distance == matrix.infinity()) {
+        std::cout << "sem caminho\n";
+        return;
+    }
+    if (!matrix.hasPaths()) {
+        std::cout << distance << "\n";
+        return;
+    }
+    std::string path;
+    int current = from;
+    int steps = 0;
+    while (current != to && steps < matrix.vertices()) {
+        path += std::to_string(current + 1) + "->";
+        current = matrix.next(current, to);
+        ++steps;
+    }
+    if (current != to) {
+        std::cout << "caminho indefinido (ciclo negativo)\n";
+        return;
+    }
+    std::cout << path << to + 1 << " (custo: " << distance << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string matrixFile, queriesFile;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "-h") {
+            displayHelp();
+            return 0;
+        } else if (arg == "-f" && i + 1 < argc) {
+            matrixFile = argv[++i];
+        } else if (arg == "-q" && i + 1 < argc) {
+            queriesFile = argv[++i];
+        }
+    }
+
+    if (matrixFile.empty()) {
+        std::cerr << "Arquivo de matriz não especificado.\n";
+        return 1;
+    }
+
+    ApspMatrixView matrix;
+    if (!matrix.open(matrixFile.c_str())) {
+        std::cerr << "Arquivo de matriz inválido: " << matrixFile << "\n";
+        return 1;
+    }
+
+    std::ifstream queryFile;
+    if (!queriesFile.empty()) {
+        queryFile.open(queriesFile);
+        if (!queryFile) {
+            std::cerr << "Erro ao abrir o arquivo de consultas: " << queriesFile << "\n";
+            return 1;
+        }
+    }
+    std::istream& queries = queriesFile.empty() ? std::cin : queryFile;
+
+    long u, v;
+    while (queries >> u >> v) {
+        answer(matrix, u, v);
+    }
+    return 0;
+}
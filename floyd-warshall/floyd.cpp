@@ -3,119 +3,1089 @@
 #include <fstream>
 #include <string>
 #include <limits>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <queue>
+#include <functional>
+#include <sstream>
+#include <cstdlib>
+#include <cstdint>
+#include <unordered_map>
 
+#include "worker_pool.h"
+#include "graph_reader.h"
+#include "graph_snapshot.h"
+#include "output_writer.h"
+#include "minplus.h"
+#include "apsp_format.h"
+#include "tiled_matrix_file.h"
+
+struct WeightedEdge {
+    int from;
+    int to;
+    long long weight;
+    WeightedEdge(int u, int v, long long w) : from(u), to(v), weight(w) {}
+};
+
+struct ShortestPathInput {
+    int vertices;
+    std::vector<WeightedEdge> edges;
+    std::vector<WeightedEdge> effectiveEdges;
+    std::vector<long long> potential;
+    std::vector<int> negativeCycle;
+    long long negativeCycleCost;
+    long long maxAbsWeight;
+    long long uniformWeight;
+    bool hasNegativeEdge;
+    bool negativeCycleFound;
+    bool uniformWeights;
+    bool negativeUpdates;
+
+    explicit ShortestPathInput(int v)
+        : vertices(v), negativeCycleCost(0), maxAbsWeight(0), uniformWeight(0), hasNegativeEdge(false),
+          negativeCycleFound(false), uniformWeights(false), negativeUpdates(false) {}
+
+    void addEdge(int u, int v, long long weight) {
+        edges.emplace_back(u, v, weight);
+        maxAbsWeight = std::max(maxAbsWeight, weight < 0 ? -weight : weight);
+        if (weight < 0) hasNegativeEdge = true;
+    }
+
+    // Weights that will arrive later through --updates must also fit the
+    // distance type picked now.
+    void reserveUpdateWeight(long long weight) {
+        maxAbsWeight = std::max(maxAbsWeight, weight < 0 ? -weight : weight);
+        if (weight < 0) negativeUpdates = true;
+    }
+
+    void keepLastWeightPerPair() {
+        std::vector<size_t> order(edges.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (edges[a].from != edges[b].from) return edges[a].from < edges[b].from;
+            if (edges[a].to != edges[b].to) return edges[a].to < edges[b].to;
+            return a < b;
+        });
+        std::vector<bool> keep(edges.size(), false);
+        for (size_t i = 0; i < order.size(); ++i) {
+            bool lastOfPair = i + 1 == order.size() || edges[order[i + 1]].from != edges[order[i]].from ||
+                              edges[order[i + 1]].to != edges[order[i]].to;
+            if (lastOfPair) keep[order[i]] = true;
+        }
+        effectiveEdges.clear();
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (keep[i]) effectiveEdges.push_back(edges[i]);
+        }
+    }
+
+    bool computePotentials() {
+        potential.assign(vertices, 0);
+        std::vector<int> predecessor(vertices, -1);
+        std::vector<long long> predecessorWeight(vertices, 0);
+        int lastRelaxed = -1;
+        for (int round = 0; round < vertices; ++round) {
+            lastRelaxed = -1;
+            for (const auto& edge : effectiveEdges) {
+                if (potential[edge.from] + edge.weight < potential[edge.to]) {
+                    potential[edge.to] = potential[edge.from] + edge.weight;
+                    predecessor[edge.to] = edge.from;
+                    predecessorWeight[edge.to] = edge.weight;
+                    lastRelaxed = edge.to;
+                }
+            }
+            if (lastRelaxed == -1) return true;
+        }
+
+        int onCycle = lastRelaxed;
+        for (int i = 0; i < vertices; ++i) {
+            onCycle = predecessor[onCycle];
+        }
+        negativeCycle.clear();
+        negativeCycleCost = 0;
+        int current = onCycle;
+        do {
+            negativeCycle.push_back(current);
+            negativeCycleCost += predecessorWeight[current];
+            current = predecessor[current];
+        } while (current != onCycle);
+        negativeCycle.push_back(onCycle);
+        std::reverse(negativeCycle.begin(), negativeCycle.end());
+        return false;
+    }
+
+    void prepare() {
+        keepLastWeightPerPair();
+        uniformWeight = effectiveEdges.empty() ? 0 : effectiveEdges[0].weight;
+        uniformWeights = uniformWeight >= 0;
+        for (const auto& edge : effectiveEdges) {
+            if (edge.weight != uniformWeight) uniformWeights = false;
+        }
+        potential.assign(vertices, 0);
+        negativeCycleFound = hasNegativeEdge && !computePotentials();
+        if (!negativeCycleFound) return;
+        std::cerr << "Ciclo negativo detectado: ";
+        for (size_t i = 0; i < negativeCycle.size(); ++i) {
+            if (i > 0) std::cerr << "->";
+            std::cerr << negativeCycle[i] + 1;
+        }
+        std::cerr << " (custo: " << negativeCycleCost << ")\n";
+    }
+
+    // Without a negative cycle every intermediate Floyd value is the weight of a
+    // simple path, so |d| <= (V-1)*maxAbsWeight and any sum of two cells stays
+    // below the infinity sentinel of the chosen type.
+    template <typename Dist>
+    bool fits() const {
+        long double bound = static_cast<long double>(std::max(vertices - 1, 1)) * maxAbsWeight;
+        return 2 * bound < static_cast<long double>(std::numeric_limits<Dist>::max());
+    }
+};
+
+template <typename Dist>
 class AllPairsGraph {
 private:
+    static constexpr Dist INF = std::numeric_limits<Dist>::max();
+
     int vertices;
-    std::vector<std::vector<int>> distances;
-    std::vector<std::vector<int>> nextVertex;
+    int tileSize;
+    bool trackPaths;
+    WorkerPool& pool;
+    typename MinPlus<Dist>::Kernel relax;
+    ShortestPathInput input;
+    std::string algorithm;
+    std::vector<Dist> distances;
+    std::vector<int> nextVertex;
+    std::unordered_map<long long, long long> edgeWeights;
 
-public:
-    AllPairsGraph(int v) : vertices(v) {
-        distances.resize(v, std::vector<int>(v, std::numeric_limits<int>::max()));
-        nextVertex.resize(v, std::vector<int>(v, -1));
-        for (int i = 0; i < v; ++i) {
-            distances[i][i] = 0;
+    Dist& dist(int i, int j) { return distances[static_cast<size_t>(i) * vertices + j]; }
+    int& next(int i, int j) { return nextVertex[static_cast<size_t>(i) * vertices + j]; }
+    Dist* distanceRow(int i) { return &distances[static_cast<size_t>(i) * vertices]; }
+    int* nextRow(int i) { return trackPaths ? &nextVertex[static_cast<size_t>(i) * vertices] : nullptr; }
+
+    void resetMatrices() {
+        size_t cells = static_cast<size_t>(vertices) * vertices;
+        distances.assign(cells, INF);
+        if (trackPaths) nextVertex.assign(cells, -1);
+        for (int i = 0; i < vertices; ++i) {
+            dist(i, i) = 0;
+        }
+        for (const auto& edge : input.edges) {
+            dist(edge.from, edge.to) = static_cast<Dist>(edge.weight);
+            if (trackPaths) next(edge.from, edge.to) = edge.to;
         }
     }
 
-    void addEdge(int u, int v, int weight) {
-        distances[u][v] = weight; 
-        nextVertex[u][v] = v;
+    void relaxTile(int iBegin, int iEnd, int jBegin, int jEnd, int kBegin, int kEnd) {
+        for (int k = kBegin; k < kEnd; ++k) {
+            const Dist* rowK = distanceRow(k);
+            for (int i = iBegin; i < iEnd; ++i) {
+                Dist* rowI = distanceRow(i);
+                int* nextI = nextRow(i);
+                if (rowI[k] == INF) continue;
+                relax(rowI, nextI, rowK, rowI[k], nextI ? nextI[k] : 0, jBegin, jEnd);
+            }
+        }
     }
 
-    void floydWarshall() {
+    void blockedFloydWarshall() {
+        int blocks = (vertices + tileSize - 1) / tileSize;
+        for (int kb = 0; kb < blocks; ++kb) {
+            int kBegin = kb * tileSize;
+            int kEnd = std::min(kBegin + tileSize, vertices);
+
+            relaxTile(kBegin, kEnd, kBegin, kEnd, kBegin, kEnd);
+
+            pool.parallelFor(2 * blocks, [&](int task) {
+                int b = task / 2;
+                if (b == kb) return;
+                int begin = b * tileSize;
+                int end = std::min(begin + tileSize, vertices);
+                if (task % 2 == 0) {
+                    relaxTile(kBegin, kEnd, begin, end, kBegin, kEnd);
+                } else {
+                    relaxTile(begin, end, kBegin, kEnd, kBegin, kEnd);
+                }
+            });
+
+            pool.parallelFor(blocks * blocks, [&](int task) {
+                int ib = task / blocks;
+                int jb = task % blocks;
+                if (ib == kb || jb == kb) return;
+                int iBegin = ib * tileSize;
+                int jBegin = jb * tileSize;
+                relaxTile(iBegin, std::min(iBegin + tileSize, vertices),
+                          jBegin, std::min(jBegin + tileSize, vertices), kBegin, kEnd);
+            });
+        }
+    }
+
+    void relaxRowClassic(int i, int k, const Dist* rowK) {
+        Dist* rowI = distanceRow(i);
+        int* nextI = nextRow(i);
+        if (rowI[k] == INF) return;
+        relax(rowI, nextI, rowK, rowI[k], nextI ? nextI[k] : 0, 0, k);
+        relax(rowI, nextI, rowK, rowI[k], nextI ? nextI[k] : 0, k, k + 1);
+        relax(rowI, nextI, rowK, rowI[k], nextI ? nextI[k] : 0, k + 1, vertices);
+    }
+
+    // Rows before k must see row k as it was before step k and rows after it the
+    // updated one, exactly as in the serial loop, so row k is snapshotted first.
+    void classicFloydWarshall() {
+        std::vector<Dist> previousRowK(vertices);
         for (int k = 0; k < vertices; ++k) {
+            Dist* rowK = distanceRow(k);
+            std::copy(rowK, rowK + vertices, previousRowK.begin());
+            relaxRowClassic(k, k, rowK);
+            pool.parallelFor(vertices, [&](int i) {
+                if (i != k) relaxRowClassic(i, k, i < k ? previousRowK.data() : rowK);
+            });
+        }
+    }
+
+    void buildAdjacency(std::vector<int>& offsets, std::vector<int>& targets, std::vector<size_t>& edgeOf) {
+        offsets.assign(vertices + 1, 0);
+        for (const auto& edge : input.effectiveEdges) {
+            if (edge.from != edge.to) ++offsets[edge.from + 1];
+        }
+        for (int v = 0; v < vertices; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        targets.resize(offsets[vertices]);
+        edgeOf.resize(offsets[vertices]);
+        std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < input.effectiveEdges.size(); ++e) {
+            const WeightedEdge& edge = input.effectiveEdges[e];
+            if (edge.from == edge.to) continue;
+            int slot = fill[edge.from]++;
+            targets[slot] = edge.to;
+            edgeOf[slot] = e;
+        }
+    }
+
+    // Bit b of a word stands for source first + b, so one sweep over the
+    // frontier advances up to 64 traversals; rows receive hop counts.
+    void breadthFirstBatch(int first, int count, const std::vector<int>& offsets, const std::vector<int>& targets) {
+        std::vector<uint64_t> visited(vertices, 0), frontier(vertices, 0), reached(vertices, 0);
+        std::vector<int> current, touched;
+        for (int b = 0; b < count; ++b) {
+            int source = first + b;
+            Dist* row = distanceRow(source);
+            std::fill(row, row + vertices, INF);
+            row[source] = 0;
+            visited[source] |= 1ULL << b;
+            frontier[source] |= 1ULL << b;
+            current.push_back(source);
+        }
+
+        for (int level = 1; !current.empty(); ++level) {
+            for (int u : current) {
+                for (int e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = targets[e];
+                    if (!reached[v]) touched.push_back(v);
+                    reached[v] |= frontier[u];
+                }
+                frontier[u] = 0;
+            }
+            current.clear();
+            for (int v : touched) {
+                uint64_t fresh = reached[v] & ~visited[v];
+                reached[v] = 0;
+                if (!fresh) continue;
+                visited[v] |= fresh;
+                frontier[v] = fresh;
+                current.push_back(v);
+                for (; fresh; fresh &= fresh - 1) {
+                    distanceRow(first + __builtin_ctzll(fresh))[v] = static_cast<Dist>(level);
+                }
+            }
+            touched.clear();
+        }
+    }
+
+    // The first hop toward j is any neighbor one hop closer to j.
+    void deriveNextHops(int i, const std::vector<int>& offsets, const std::vector<int>& targets) {
+        const Dist* row = distanceRow(i);
+        int* nextI = nextRow(i);
+        for (int j = 0; j < vertices; ++j) {
+            if (j == i) continue;
+            nextI[j] = -1;
+            if (row[j] == INF) continue;
+            for (int e = offsets[i]; e < offsets[i + 1]; ++e) {
+                if (dist(targets[e], j) == row[j] - 1) {
+                    nextI[j] = targets[e];
+                    break;
+                }
+            }
+        }
+    }
+
+    // With every weight equal to w >= 0, d(i, j) = hops(i, j) * w, and a
+    // self-loop keeps w on the diagonal because any longer cycle costs more.
+    bool breadthFirstAllPairs() {
+        if (!input.uniformWeights || input.negativeCycleFound || vertices - 1 >= static_cast<long long>(INF)) {
+            return false;
+        }
+        std::vector<int> offsets, targets;
+        std::vector<size_t> edgeOf;
+        buildAdjacency(offsets, targets, edgeOf);
+        std::vector<char> selfLoop(vertices, 0);
+        for (const auto& edge : input.effectiveEdges) {
+            if (edge.from == edge.to) selfLoop[edge.from] = 1;
+        }
+
+        pool.parallelFor((vertices + 63) / 64, [&](int batch) {
+            breadthFirstBatch(batch * 64, std::min(64, vertices - batch * 64), offsets, targets);
+        });
+        if (trackPaths) {
+            pool.parallelFor(vertices, [&](int i) { deriveNextHops(i, offsets, targets); });
+        }
+        pool.parallelFor(vertices, [&](int i) {
+            Dist* row = distanceRow(i);
+            for (int j = 0; j < vertices; ++j) {
+                if (row[j] != INF) row[j] = static_cast<Dist>(row[j] * input.uniformWeight);
+            }
+            row[i] = selfLoop[i] ? static_cast<Dist>(input.uniformWeight) : 0;
+        });
+        return true;
+    }
+
+    void dijkstraFromSource(int source, const std::vector<int>& offsets, const std::vector<int>& targets,
+                            const std::vector<long long>& reducedWeights) {
+        std::vector<long long> reduced(vertices, std::numeric_limits<long long>::max());
+        std::vector<int> firstHop(vertices, -1);
+        std::vector<bool> settled(vertices, false);
+        std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>,
+                            std::greater<std::pair<long long, int>>> queue;
+
+        Dist* row = distanceRow(source);
+        int* nextInRow = nextRow(source);
+        Dist selfLoop = row[source];
+
+        reduced[source] = 0;
+        firstHop[source] = source;
+        queue.emplace(0, source);
+        while (!queue.empty()) {
+            int current = queue.top().second;
+            queue.pop();
+            if (settled[current]) continue;
+            settled[current] = true;
+            for (int e = offsets[current]; e < offsets[current + 1]; ++e) {
+                int neighbor = targets[e];
+                long long candidate = reduced[current] + reducedWeights[e];
+                if (candidate < reduced[neighbor]) {
+                    reduced[neighbor] = candidate;
+                    firstHop[neighbor] = current == source ? neighbor : firstHop[current];
+                    queue.emplace(candidate, neighbor);
+                }
+            }
+        }
+
+        for (int v = 0; v < vertices; ++v) {
+            if (v == source) continue;
+            row[v] = settled[v] ? static_cast<Dist>(reduced[v] - input.potential[source] + input.potential[v]) : INF;
+            if (nextInRow) nextInRow[v] = settled[v] ? firstHop[v] : -1;
+        }
+
+        row[source] = 0;
+        if (selfLoop > 0) {
+            long long best = selfLoop;
+            int bestHop = source;
+            for (const auto& edge : input.effectiveEdges) {
+                if (edge.to != source || edge.from == source || row[edge.from] == INF) continue;
+                if (row[edge.from] + edge.weight < best) {
+                    best = row[edge.from] + edge.weight;
+                    bestHop = nextInRow ? nextInRow[edge.from] : -1;
+                }
+            }
+            row[source] = static_cast<Dist>(best);
+            if (nextInRow) nextInRow[source] = bestHop;
+        }
+    }
+
+    void indexEdgeWeights() {
+        if (!edgeWeights.empty()) return;
+        for (const auto& edge : input.effectiveEdges) {
+            edgeWeights[static_cast<long long>(edge.from) * vertices + edge.to] = edge.weight;
+        }
+    }
+
+public:
+    AllPairsGraph(ShortestPathInput graphInput, int tile, bool paths, WorkerPool& workers,
+                  typename MinPlus<Dist>::Kernel kernel)
+        : vertices(graphInput.vertices), tileSize(tile > 0 ? tile : 64), trackPaths(paths), pool(workers),
+          relax(kernel), input(std::move(graphInput)) {
+        resetMatrices();
+    }
+
+    // With a negative cycle the distances depend on the relaxation order (and may
+    // wrap around), so only the textbook k-i-j order reproduces them. The same
+    // goes for successors among equal-cost paths: blocking would make them
+    // depend on -b.
+    void floydWarshall() {
+        if (input.negativeCycleFound || trackPaths) {
+            classicFloydWarshall();
+        } else {
+            blockedFloydWarshall();
+        }
+    }
+
+    bool johnson() {
+        if (input.negativeCycleFound) return false;
+
+        std::vector<int> offsets, targets;
+        std::vector<size_t> edgeOf;
+        buildAdjacency(offsets, targets, edgeOf);
+        std::vector<long long> reducedWeights(targets.size());
+        for (size_t slot = 0; slot < targets.size(); ++slot) {
+            const WeightedEdge& edge = input.effectiveEdges[edgeOf[slot]];
+            reducedWeights[slot] = edge.weight + input.potential[edge.from] - input.potential[edge.to];
+        }
+
+        pool.parallelFor(vertices, [&](int source) {
+            dijkstraFromSource(source, offsets, targets, reducedWeights);
+        });
+        return true;
+    }
+
+    void solve(const std::string& requested) {
+        algorithm = requested;
+        edgeWeights.clear();
+        if ((algorithm == "auto" || algorithm == "bfs") && breadthFirstAllPairs()) return;
+        bool useJohnson = algorithm == "johnson" ||
+                          (algorithm != "floyd" && input.edges.size() * 64 < static_cast<size_t>(vertices) * vertices);
+        if (!useJohnson || !johnson()) {
+            floydWarshall();
+        }
+    }
+
+    // A lower weight on u->v only opens paths that use the edge, so one pass of
+    // d(i, j) = min(d(i, j), d(i, u) + w + d(v, j)) brings the matrix up to date.
+    void decreaseEdge(int u, int v, long long weight, std::vector<char>& changedRows) {
+        std::vector<Dist> rowV(distanceRow(v), distanceRow(v) + vertices);
+        rowV[v] = 0;
+        indexEdgeWeights();
+        edgeWeights[static_cast<long long>(u) * vertices + v] = weight;
+        input.addEdge(u, v, weight);
+
+        pool.parallelFor(vertices, [&](int i) {
+            Dist* rowI = distanceRow(i);
+            int* nextI = nextRow(i);
+            long long toU = i == u ? 0 : static_cast<long long>(rowI[u]);
+            if (i != u && rowI[u] == INF) return;
+            int firstHop = i == u ? v : (nextI ? nextI[u] : -1);
+            for (int j = 0; j < vertices; ++j) {
+                if (rowV[j] == INF) continue;
+                long long candidate = toU + weight + rowV[j];
+                if (rowI[j] == INF || candidate < rowI[j]) {
+                    rowI[j] = static_cast<Dist>(candidate);
+                    if (nextI) nextI[j] = firstHop;
+                    changedRows[i] = 1;
+                }
+            }
+        });
+    }
+
+    // Sets the weight of u->v. Self-loops, weight increases and anything that
+    // involves a negative cycle are recomputed from the edge list instead.
+    void addEdge(int u, int v, long long weight, std::vector<char>& changedRows) {
+        indexEdgeWeights();
+        auto existing = edgeWeights.find(static_cast<long long>(u) * vertices + v);
+        bool lowers = existing == edgeWeights.end() || weight < existing->second;
+        bool closesNegativeCycle = dist(v, u) != INF && dist(v, u) + weight < 0;
+        if (u != v && lowers && !input.negativeCycleFound && !closesNegativeCycle) {
+            decreaseEdge(u, v, weight, changedRows);
+            return;
+        }
+        if (existing != edgeWeights.end() && existing->second == weight) return;
+
+        std::vector<Dist> previous = distances;
+        input.addEdge(u, v, weight);
+        input.prepare();
+        resetMatrices();
+        solve(algorithm);
+        for (int i = 0; i < vertices; ++i) {
+            if (!std::equal(distances.begin() + static_cast<size_t>(i) * vertices,
+                            distances.begin() + static_cast<size_t>(i + 1) * vertices,
+                            previous.begin() + static_cast<size_t>(i) * vertices)) {
+                changedRows[i] = 1;
+            }
+        }
+    }
+
+    void applyUpdates(const std::vector<WeightedEdge>& updates, OutputWriter& out) {
+        std::vector<char> changedRows(vertices);
+        double totalSeconds = 0;
+        for (const auto& update : updates) {
+            out.put("Atualização ");
+            out.putInteger(update.from + 1);
+            out.put("->");
+            out.putInteger(update.to + 1);
+            out.put(" (peso ");
+            out.putInteger(update.weight);
+            out.put("): ");
+            if (update.from < 0 || update.to < 0 || update.from >= vertices || update.to >= vertices) {
+                out.put("vértice inválido\n");
+                continue;
+            }
+
+            std::fill(changedRows.begin(), changedRows.end(), 0);
+            auto start = std::chrono::steady_clock::now();
+            addEdge(update.from, update.to, update.weight, changedRows);
+            totalSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            out.putInteger(std::count(changedRows.begin(), changedRows.end(), 1));
+            out.put(" linha(s) alterada(s)\n");
             for (int i = 0; i < vertices; ++i) {
+                if (!changedRows[i]) continue;
+                out.putInteger(i + 1);
+                out.put(':');
                 for (int j = 0; j < vertices; ++j) {
-                    if (distances[i][k] != std::numeric_limits<int>::max() &&
-                        distances[k][j] != std::numeric_limits<int>::max() &&
-                        distances[i][j] > distances[i][k] + distances[k][j]) {
-                        distances[i][j] = distances[i][k] + distances[k][j];
-                        nextVertex[i][j] = nextVertex[i][k];
+                    out.put(' ');
+                    if (dist(i, j) == INF) {
+                        out.put('-');
+                    } else {
+                        out.putInteger(dist(i, j));
                     }
                 }
+                out.put('\n');
             }
         }
+        out.flush();
+        if (!updates.empty()) {
+            std::cerr << updates.size() << " atualizações, média de " << totalSeconds * 1000 / updates.size()
+                      << " ms por atualização\n";
+        }
     }
 
-    void printDistances(bool showPaths, std::ofstream& outFile) {
+    void appendPath(std::string& buffer, int from, int to) {
+        buffer += "Caminho ";
+        appendInteger(buffer, from + 1);
+        buffer += "->";
+        appendInteger(buffer, to + 1);
+        buffer += ": ";
+        if (from < 0 || to < 0 || from >= vertices || to >= vertices) {
+            buffer += "vértice inválido\n";
+            return;
+        }
+        if (dist(from, to) == INF) {
+            buffer += "sem caminho\n";
+            return;
+        }
+        size_t pathStart = buffer.size();
+        int u = from;
+        int steps = 0;
+        while (u != to && steps < vertices) {
+            appendInteger(buffer, u + 1);
+            buffer += "->";
+            u = next(u, to);
+            ++steps;
+        }
+        if (u != to) {
+            buffer.resize(pathStart);
+            buffer += "caminho indefinido (ciclo negativo)\n";
+            return;
+        }
+        appendInteger(buffer, to + 1);
+        buffer += " (custo: ";
+        appendInteger(buffer, dist(from, to));
+        buffer += ")\n";
+    }
+
+    void answerQueries(const std::string& queries, OutputWriter& out) {
+        std::string line;
+        const char* cursor = queries.c_str();
+        char* end;
+        while (true) {
+            long u = std::strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            long v = std::strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            line.clear();
+            appendPath(line, static_cast<int>(u) - 1, static_cast<int>(v) - 1);
+            out.put(line);
+        }
+    }
+
+    void writeBinary(std::ofstream& outFile) {
+        ApspFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, APSP_MAGIC, sizeof(header.magic));
+        header.version = APSP_VERSION;
+        header.vertices = static_cast<uint32_t>(vertices);
+        header.flags = trackPaths ? APSP_HAS_NEXT : 0;
+        header.distanceBytes = sizeof(Dist);
+        header.infinity = INF;
+        header.distanceOffset = sizeof(ApspFileHeader);
+        header.nextOffset = trackPaths ? header.distanceOffset + distances.size() * sizeof(Dist) : 0;
+
+        outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        outFile.write(reinterpret_cast<const char*>(distances.data()), distances.size() * sizeof(Dist));
+        if (trackPaths) {
+            outFile.write(reinterpret_cast<const char*>(nextVertex.data()), nextVertex.size() * sizeof(int32_t));
+        }
+    }
+
+    void printDistances(bool showPaths, OutputWriter& out) {
         for (int i = 0; i < vertices; ++i) {
             for (int j = 0; j < vertices; ++j) {
-                if (distances[i][j] == std::numeric_limits<int>::max()) {
-                    std::cout << "-";
-                    outFile << "-";
+                if (dist(i, j) == INF) {
+                    out.put('-');
                 } else {
-                    std::cout << distances[i][j];
-                    outFile << distances[i][j];
-                }
-                if (j < vertices - 1) {
-                    std::cout << " ";
-                    outFile << " ";
+                    out.putInteger(dist(i, j));
                 }
+                if (j < vertices - 1) out.put(' ');
             }
-            std::cout << "\n";
-            outFile << "\n";
+            out.put('\n');
         }
 
         if (showPaths) {
+            std::string line;
             for (int i = 0; i < vertices; ++i) {
                 for (int j = 0; j < vertices; ++j) {
-                    if (distances[i][j] != std::numeric_limits<int>::max() && i != j) {
-                        std::cout << "Caminho " << (i + 1) << "->" << (j + 1) << ": ";
-                        outFile << "Caminho " << (i + 1) << "->" << (j + 1) << ": ";
-                        int u = i, v = j;
-                        std::vector<int> path;
-                        while (u != v) {
-                            path.push_back(u + 1);
-                            u = nextVertex[u][v];
-                        }
-                        path.push_back(v + 1);
-                        for (size_t k = 0; k < path.size(); ++k) {
-                            std::cout << path[k];
-                            outFile << path[k];
-                            if (k < path.size() - 1) {
-                                std::cout << "->";
-                                outFile << "->";
-                            }
-                        }
-                        std::cout << " (custo: " << distances[i][j] << ")\n";
-                        outFile << " (custo: " << distances[i][j] << ")\n";
+                    if (dist(i, j) != INF && i != j) {
+                        line.clear();
+                        appendPath(line, i, j);
+                        out.put(line);
+                    }
+                }
+            }
+        }
+    }
+};
+
+template <typename Dist>
+constexpr Dist AllPairsGraph<Dist>::INF;
+
+// Blocked Floyd-Warshall over a TiledMatrixFile: only a bounded number of
+// tiles is resident, and the matrix on disk is checkpointed after each k-block.
+template <typename Dist>
+class OutOfCoreFloyd {
+private:
+    static constexpr Dist INF = std::numeric_limits<Dist>::max();
+
+    const ShortestPathInput& input;
+    int vertices;
+    int tileSize;
+    typename MinPlus<Dist>::Kernel relax;
+    TiledMatrixFile<Dist> matrix;
+
+    uint64_t inputHash() const {
+        uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&](long long value) {
+            for (int byte = 0; byte < 8; ++byte) {
+                hash ^= static_cast<uint64_t>(value >> (8 * byte)) & 0xff;
+                hash *= 1099511628211ULL;
+            }
+        };
+        mix(vertices);
+        for (const auto& edge : input.effectiveEdges) {
+            mix(edge.from);
+            mix(edge.to);
+            mix(edge.weight);
+        }
+        return hash;
+    }
+
+    void initializeTiles() {
+        int blocks = matrix.blockCount();
+        std::vector<size_t> order(input.effectiveEdges.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        auto tileOf = [&](size_t e) {
+            const WeightedEdge& edge = input.effectiveEdges[e];
+            return static_cast<long long>(edge.from / tileSize) * blocks + edge.to / tileSize;
+        };
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return tileOf(a) < tileOf(b); });
+
+        size_t cursor = 0;
+        for (int ib = 0; ib < blocks; ++ib) {
+            for (int jb = 0; jb < blocks; ++jb) {
+                Dist* cells = matrix.tile(ib, jb, true);
+                std::fill(cells, cells + static_cast<size_t>(tileSize) * tileSize, INF);
+                if (ib == jb) {
+                    for (int r = 0; r < tileSize && ib * tileSize + r < vertices; ++r) {
+                        cells[r * tileSize + r] = 0;
+                    }
+                }
+                for (; cursor < order.size() && tileOf(order[cursor]) == static_cast<long long>(ib) * blocks + jb;
+                     ++cursor) {
+                    const WeightedEdge& edge = input.effectiveEdges[order[cursor]];
+                    cells[(edge.from % tileSize) * tileSize + edge.to % tileSize] = static_cast<Dist>(edge.weight);
+                }
+            }
+        }
+        matrix.checkpoint(0);
+    }
+
+    void relaxTile(Dist* target, const Dist* columnTile, const Dist* rowTile, int kCount) {
+        for (int k = 0; k < kCount; ++k) {
+            const Dist* rowK = rowTile + k * tileSize;
+            for (int i = 0; i < tileSize; ++i) {
+                Dist throughK = columnTile[i * tileSize + k];
+                if (throughK == INF) continue;
+                relax(target + i * tileSize, nullptr, rowK, throughK, 0, 0, tileSize);
+            }
+        }
+    }
+
+public:
+    OutOfCoreFloyd(const ShortestPathInput& graphInput, int tile, typename MinPlus<Dist>::Kernel kernel)
+        : input(graphInput), vertices(graphInput.vertices), tileSize((std::max(tile, 1) + 63) / 64 * 64),
+          relax(kernel) {}
+
+    bool open(const std::string& path, size_t cacheBytes) {
+        bool resumed = false;
+        if (!matrix.open(path, vertices, tileSize, inputHash(), cacheBytes, resumed)) {
+            std::cerr << "Erro ao abrir o arquivo da matriz: " << path << "\n";
+            return false;
+        }
+        if (resumed) {
+            std::cerr << "Retomando do bloco " << matrix.completedBlocks() << " de " << matrix.blockCount() << "\n";
+        } else {
+            initializeTiles();
+        }
+        return true;
+    }
+
+    // Checkpoints every checkpointEvery k-blocks (0 picks about 16 over the
+    // run): each one syncs every dirty tile, up to the whole matrix.
+    void solve(int checkpointEvery) {
+        int blocks = matrix.blockCount();
+        int interval = checkpointEvery > 0 ? checkpointEvery : std::max(1, blocks / 16);
+        for (int kb = matrix.completedBlocks(); kb < blocks; ++kb) {
+            int kCount = std::min(tileSize, vertices - kb * tileSize);
+            Dist* diagonal = matrix.tile(kb, kb, true);
+            relaxTile(diagonal, diagonal, diagonal, kCount);
+
+            for (int b = 0; b < blocks; ++b) {
+                if (b == kb) continue;
+                Dist* rowTile = matrix.tile(kb, b, true);
+                relaxTile(rowTile, matrix.tile(kb, kb, false), rowTile, kCount);
+                Dist* columnTile = matrix.tile(b, kb, true);
+                relaxTile(columnTile, columnTile, matrix.tile(kb, kb, false), kCount);
+            }
+
+            for (int ib = 0; ib < blocks; ++ib) {
+                if (ib == kb) continue;
+                for (int jb = 0; jb < blocks; ++jb) {
+                    if (jb == kb) continue;
+                    const Dist* columnTile = matrix.tile(ib, kb, false);
+                    const Dist* rowTile = matrix.tile(kb, jb, false);
+                    relaxTile(matrix.tile(ib, jb, true), columnTile, rowTile, kCount);
+                }
+            }
+            if ((kb + 1) % interval == 0 || kb + 1 == blocks) matrix.checkpoint(kb + 1);
+        }
+    }
+
+    // Rows are emitted one tile row at a time, so the output buffer holds
+    // tileSize rows instead of the whole matrix.
+    void write(bool binary, std::ofstream& outFile, bool echo) {
+        int blocks = matrix.blockCount();
+        size_t rowWidth = static_cast<size_t>(blocks) * tileSize;
+        std::vector<Dist> band(rowWidth * tileSize);
+        OutputWriter out(binary ? nullptr : &outFile, !binary && echo);
+
+        if (binary) {
+            ApspFileHeader header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, APSP_MAGIC, sizeof(header.magic));
+            header.version = APSP_VERSION;
+            header.vertices = static_cast<uint32_t>(vertices);
+            header.distanceBytes = sizeof(Dist);
+            header.infinity = INF;
+            header.distanceOffset = sizeof(ApspFileHeader);
+            outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        for (int ib = 0; ib < blocks; ++ib) {
+            for (int jb = 0; jb < blocks; ++jb) {
+                const Dist* cells = matrix.tile(ib, jb, false);
+                for (int r = 0; r < tileSize; ++r) {
+                    std::copy(cells + r * tileSize, cells + (r + 1) * tileSize,
+                              band.begin() + r * rowWidth + static_cast<size_t>(jb) * tileSize);
+                }
+            }
+            for (int r = 0; r < tileSize && ib * tileSize + r < vertices; ++r) {
+                const Dist* row = &band[r * rowWidth];
+                if (binary) {
+                    outFile.write(reinterpret_cast<const char*>(row), vertices * sizeof(Dist));
+                    continue;
+                }
+                for (int j = 0; j < vertices; ++j) {
+                    if (row[j] == INF) {
+                        out.put('-');
+                    } else {
+                        out.putInteger(row[j]);
                     }
+                    if (j < vertices - 1) out.put(' ');
                 }
+                out.put('\n');
             }
         }
+        out.flush();
+        matrix.dropAll();
+    }
+
+    void reportVolume() const {
+        std::cerr << "E/S de tiles: " << matrix.readVolume() / (1024.0 * 1024.0) << " MiB lidos, "
+                  << matrix.evictedVolume() / (1024.0 * 1024.0) << " MiB alterados devolvidos ao liberar tiles, "
+                  << matrix.checkpointVolume() / (1024.0 * 1024.0) << " MiB gravados em " << matrix.checkpointCount()
+                  << " checkpoints\n";
     }
 };
 
+template <typename Dist>
+constexpr Dist OutOfCoreFloyd<Dist>::INF;
+
+struct FloydOptions {
+    bool showPaths;
+    int tileSize;
+    int threads;
+    std::string isa;
+    std::string algorithm;
+    std::string queriesFile;
+    std::string format;
+    std::string distanceType;
+    std::string matrixFile;
+    std::string updatesFile;
+    std::string convertFile;
+    size_t cacheMegabytes;
+    int checkpointBlocks;
+    bool echo;
+    FloydOptions()
+        : showPaths(false), tileSize(64), threads(1), algorithm("auto"), format("text"), distanceType("auto"),
+          cacheMegabytes(256), checkpointBlocks(0), echo(false) {}
+};
+
 void displayHelp() {
     std::cout << "-h : mostra o help\n";
     std::cout << "-o <arquivo> : redireciona a saida para o arquivo\n";
+    std::cout << "--echo : repete a saída no console (por padrão ela só vai para o arquivo)\n";
     std::cout << "-f <arquivo> : indica o arquivo que contém o grafo de entrada\n";
     std::cout << "-s : mostra os caminhos\n";
+    std::cout << "-t <threads> : número de threads (0 usa todos os núcleos)\n";
+    std::cout << "-b <tamanho> : tamanho do bloco (tile) do Floyd-Warshall (padrão 64)\n";
+    std::cout << "-q, --queries <arquivo> : responde apenas os pares \"u v\" do arquivo (- lê da entrada padrão)\n";
+    std::cout << "--updates <arquivo> : aplica as arestas \"u v w\" do arquivo uma a uma e mostra só as linhas alteradas\n";
+    std::cout << "--format <text|bin> : bin grava cabeçalho + matriz de distâncias (e sucessores com -s), legível via mmap\n";
+    std::cout << "--algo <auto|floyd|johnson|bfs> : algoritmo (auto usa BFS se todos os pesos forem iguais, senão escolhe pela densidade E/V)\n";
+    std::cout << "--dist <auto|int16|int32|int64> : tipo das distâncias (auto escolhe pelo maior peso e por V)\n";
+    std::cout << "--isa <scalar|sse4.1|avx2|avx512> : força o kernel de relaxação (padrão: o melhor disponível)\n";
+    std::cout << "--out-of-core <arquivo> : mantém a matriz em disco (mmap), retomando do último bloco k concluído\n";
+    std::cout << "--cache-mb <n> : memória para tiles residentes no modo --out-of-core (padrão 256)\n";
+    std::cout << "--checkpoint-every <n> : blocos k entre checkpoints do modo --out-of-core (padrão: cerca de 16 no total)\n";
+    std::cout << "--convert <snapshot> : grava o grafo lido num snapshot binário (CSR direcionado), aceito por -f\n";
+    std::cout << "--bench [n] : mede células relaxadas por segundo de cada kernel numa matriz n x n\n";
 }
 
-void processInput(const std::string& inputFile, const std::string& outputFile, bool showPaths) {
-    std::ifstream inFile(inputFile);
-    std::ofstream outFile(outputFile);
+template <typename Dist>
+void runKernelBenchmark(int size, const char* typeName) {
+    const Dist inf = std::numeric_limits<Dist>::max();
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> weight(-50, 100);
+    std::vector<Dist> baseDistances(static_cast<size_t>(size) * size);
+    for (auto& cell : baseDistances) {
+        cell = random() % 8 == 0 ? inf : static_cast<Dist>(weight(random));
+    }
+    std::vector<int> baseNext(baseDistances.size(), 0);
+    int steps = std::min(size, 64);
+
+    RelaxKernelInfo<Dist> kernels[4];
+    int count = availableRelaxKernels(kernels);
+    for (int kernel = 0; kernel < count; ++kernel) {
+        std::vector<Dist> distances = baseDistances;
+        std::vector<int> nextVertex = baseNext;
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < steps; ++k) {
+            const Dist* rowK = &distances[static_cast<size_t>(k) * size];
+            for (int i = 0; i < size; ++i) {
+                Dist* rowI = &distances[static_cast<size_t>(i) * size];
+                if (i == k || rowI[k] == inf) continue;
+                kernels[kernel].kernel(rowI, &nextVertex[static_cast<size_t>(i) * size], rowK, rowI[k], k, 0, size);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cells = static_cast<double>(steps) * size * size;
+        std::cout << kernels[kernel].name << " " << typeName << ": " << cells / seconds / 1e6 << " Mcélulas/s\n";
+    }
+}
+
+bool readTextSource(const std::string& name, std::string& contents) {
+    std::stringstream stream;
+    if (name == "-") {
+        stream << std::cin.rdbuf();
+    } else {
+        std::ifstream file(name);
+        if (!file) return false;
+        stream << file.rdbuf();
+    }
+    contents = stream.str();
+    return true;
+}
+
+template <typename Dist>
+void runSolver(ShortestPathInput input, const std::vector<WeightedEdge>& updates, const FloydOptions& options,
+               std::ofstream& outFile) {
+    RelaxKernelInfo<Dist> kernel = selectRelaxKernel<Dist>(options.isa);
+    if (!kernel.kernel) {
+        std::cerr << "Kernel indisponível nesta CPU para este tipo de distância: " << options.isa << "\n";
+        return;
+    }
+
+    if (!options.matrixFile.empty()) {
+        OutOfCoreFloyd<Dist> solver(input, options.tileSize, kernel.kernel);
+        if (!solver.open(options.matrixFile, options.cacheMegabytes << 20)) return;
+        solver.solve(options.checkpointBlocks);
+        solver.write(options.format == "bin", outFile, options.echo);
+        solver.reportVolume();
+        return;
+    }
+
+    bool trackPaths = options.showPaths || !options.queriesFile.empty();
+    WorkerPool pool(options.threads);
+    AllPairsGraph<Dist> graph(std::move(input), options.tileSize, trackPaths, pool, kernel.kernel);
+    graph.solve(options.algorithm);
+
+    // The update report goes to the file too unless it holds the binary
+    // matrix; then the console is the only place left for it.
+    bool binary = options.format == "bin";
+    OutputWriter out(binary ? nullptr : &outFile, options.echo || binary);
+    if (!options.updatesFile.empty()) {
+        graph.applyUpdates(updates, out);
+    }
+
+    if (binary) {
+        graph.writeBinary(outFile);
+    } else if (!options.queriesFile.empty()) {
+        std::string queries;
+        if (!readTextSource(options.queriesFile, queries)) {
+            std::cerr << "Erro ao abrir o arquivo de consultas: " << options.queriesFile << "\n";
+            return;
+        }
+        graph.answerQueries(queries, out);
+    } else if (options.updatesFile.empty()) {
+        graph.printDistances(options.showPaths, out);
+    }
+}
+
+// A negative cycle keeps the reference int semantics (including wrap-around),
+// otherwise the narrowest type that cannot overflow is used.
+std::string chooseDistanceType(const ShortestPathInput& input, const std::string& requested) {
+    bool weightsFitInt = input.maxAbsWeight <= std::numeric_limits<int32_t>::max();
+    if (requested != "auto") {
+        bool safe = requested == "int16" ? input.fits<int16_t>() && !input.negativeCycleFound && !input.negativeUpdates :
+                    requested == "int32" ? input.fits<int32_t>() || (input.negativeCycleFound && weightsFitInt) : true;
+        return safe ? requested : "";
+    }
+    if (input.negativeCycleFound) return weightsFitInt ? "int32" : "int64";
+    if (input.fits<int16_t>() && !input.negativeUpdates) return "int16";
+    if (input.fits<int32_t>()) return "int32";
+    if (!input.fits<int64_t>()) {
+        std::cerr << "Aviso: pesos grandes demais, as distâncias podem estourar int64.\n";
+    }
+    return "int64";
+}
+
+void processInput(const std::string& inputFile, const std::string& outputFile, const FloydOptions& options) {
+    GraphFileReader inFile;
+    GraphSnapshot snapshot;
+    bool fromSnapshot = GraphSnapshot::isSnapshot(inputFile);
+    if (fromSnapshot ? !snapshot.open(inputFile) : !inFile.open(inputFile)) {
+        std::cerr << "Erro ao abrir arquivos.\n";
+        return;
+    }
+    if (fromSnapshot && !options.convertFile.empty()) {
+        std::cerr << "A entrada já é um snapshot.\n";
+        return;
+    }
 
-    if (!inFile || !outFile) {
+    int v = 0, e = 0;
+    if (fromSnapshot) {
+        v = snapshot.vertices();
+    } else {
+        inFile.read(v);
+        inFile.read(e);
+    }
+
+    if (!options.convertFile.empty()) {
+        EdgeRecords<long long> records;
+        inFile.readEdges(e, EdgeWeight::Required, v, options.threads, records);
+        std::string error;
+        if (!writeGraphSnapshot(options.convertFile, v, records.from, records.to, &records.weight, true, error)) {
+            std::cerr << "Erro ao gravar o snapshot " << options.convertFile << ": " << error << "\n";
+        }
+        return;
+    }
+
+    std::ofstream outFile(outputFile, options.format == "bin" ? std::ios::out | std::ios::binary : std::ios::out);
+    if (!outFile) {
         std::cerr << "Erro ao abrir arquivos.\n";
         return;
     }
 
-    int v, e;
-    inFile >> v >> e;
+    ShortestPathInput input(v);
+    if (fromSnapshot) {
+        std::vector<long long> storage;
+        const long long* weights = snapshot.edgeWeights(storage);
+        if (!weights) {
+            std::cerr << "Pesos do snapshot não são inteiros.\n";
+            return;
+        }
+        for (long long i = 0; i < snapshot.edgeCount(); ++i) {
+            input.addEdge(snapshot.edgeFrom()[i] - 1, snapshot.edgeTo()[i] - 1, weights[i]);
+        }
+    } else {
+        EdgeRecords<long long> records;
+        inFile.readEdges(e, EdgeWeight::Required, v, options.threads, records);
+        for (size_t i = 0; i < records.size(); ++i) {
+            input.addEdge(records.from[i] - 1, records.to[i] - 1, records.weight[i]);
+        }
+    }
+
+    input.prepare();
+
+    std::vector<WeightedEdge> updates;
+    if (!options.updatesFile.empty()) {
+        std::string contents;
+        if (!readTextSource(options.updatesFile, contents)) {
+            std::cerr << "Erro ao abrir o arquivo de atualizações: " << options.updatesFile << "\n";
+            return;
+        }
+        const char* cursor = contents.c_str();
+        char* end;
+        while (true) {
+            long u = std::strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            long v = std::strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            long long w = std::strtoll(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            updates.emplace_back(static_cast<int>(u) - 1, static_cast<int>(v) - 1, w);
+            input.reserveUpdateWeight(w);
+        }
+    }
 
-    AllPairsGraph graph(v);
-    for (int i = 0; i < e; ++i) {
-        int u, v, w;
-        inFile >> u >> v >> w;
-        graph.addEdge(u - 1, v - 1, w); 
+    if (!options.matrixFile.empty() && input.negativeCycleFound) {
+        std::cerr << "--out-of-core não suporta grafos com ciclo negativo.\n";
+        return;
     }
 
-    graph.floydWarshall();
-    graph.printDistances(showPaths, outFile);
+    std::string distanceType = chooseDistanceType(input, options.distanceType);
+    if (distanceType == "int16") {
+        runSolver<int16_t>(std::move(input), updates, options, outFile);
+    } else if (distanceType == "int32") {
+        runSolver<int32_t>(std::move(input), updates, options, outFile);
+    } else if (distanceType == "int64") {
+        runSolver<int64_t>(std::move(input), updates, options, outFile);
+    } else {
+        std::cerr << "Tipo de distância " << options.distanceType << " estreito demais para este grafo.\n";
+    }
 
     inFile.close();
     outFile.close();
@@ -123,7 +1093,9 @@ void processInput(const std::string& inputFile, const std::string& outputFile, b
 
 int main(int argc, char* argv[]) {
     std::string inputFile, outputFile = "output.bin";
-    bool showPaths = false, showHelp = false;
+    bool showHelp = false;
+    int benchSize = 0;
+    FloydOptions options;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg(argv[i]);
@@ -134,7 +1106,36 @@ int main(int argc, char* argv[]) {
         } else if (arg == "-o" && i + 1 < argc) {
             outputFile = argv[++i];
         } else if (arg == "-s") {
-            showPaths = true;
+            options.showPaths = true;
+        } else if (arg == "--echo") {
+            options.echo = true;
+        } else if (arg == "-b" && i + 1 < argc) {
+            options.tileSize = std::stoi(argv[++i]);
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            options.threads = std::stoi(argv[++i]);
+        } else if ((arg == "-q" || arg == "--queries") && i + 1 < argc) {
+            options.queriesFile = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            options.format = argv[++i];
+        } else if (arg == "--algo" && i + 1 < argc) {
+            options.algorithm = argv[++i];
+        } else if (arg == "--dist" && i + 1 < argc) {
+            options.distanceType = argv[++i];
+        } else if (arg == "--isa" && i + 1 < argc) {
+            options.isa = argv[++i];
+        } else if (arg == "--updates" && i + 1 < argc) {
+            options.updatesFile = argv[++i];
+        } else if (arg == "--out-of-core" && i + 1 < argc) {
+            options.matrixFile = argv[++i];
+        } else if (arg == "--cache-mb" && i + 1 < argc) {
+            options.cacheMegabytes = std::stoul(argv[++i]);
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            options.checkpointBlocks = std::stoi(argv[++i]);
+        } else if (arg == "--convert" && i + 1 < argc) {
+            options.convertFile = argv[++i];
+        } else if (arg == "--bench") {
+            benchSize = 2048;
+            if (i + 1 < argc && argv[i + 1][0] != '-') benchSize = std::stoi(argv[++i]);
         }
     }
 
@@ -143,11 +1144,40 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    if (benchSize > 0) {
+        runKernelBenchmark<int16_t>(benchSize, "int16");
+        runKernelBenchmark<int32_t>(benchSize, "int32");
+        runKernelBenchmark<int64_t>(benchSize, "int64");
+        return 0;
+    }
+
     if (inputFile.empty()) {
         std::cerr << "Arquivo de entrada não especificado.\n";
         return 1;
     }
 
-    processInput(inputFile, outputFile, showPaths);
+    if (options.algorithm != "auto" && options.algorithm != "floyd" && options.algorithm != "johnson" &&
+        options.algorithm != "bfs") {
+        std::cerr << "Algoritmo desconhecido: " << options.algorithm << "\n";
+        return 1;
+    }
+
+    if (options.distanceType != "auto" && options.distanceType != "int16" &&
+        options.distanceType != "int32" && options.distanceType != "int64") {
+        std::cerr << "Tipo de distância desconhecido: " << options.distanceType << "\n";
+        return 1;
+    }
+
+    if (options.format != "text" && options.format != "bin") {
+        std::cerr << "Formato de saída desconhecido: " << options.format << "\n";
+        return 1;
+    }
+
+    if (!options.matrixFile.empty() && (options.showPaths || !options.queriesFile.empty() || !options.updatesFile.empty())) {
+        std::cerr << "--out-of-core não guarda sucessores: -s, -q e --updates não são suportados.\n";
+        return 1;
+    }
+
+    processInput(inputFile, outputFile, options);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,260 @@
+#ifndef GRAFOS_MINPLUS_H
+#define GRAFOS_MINPLUS_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MINPLUS_X86 1
+#endif
+
+// Relaxes rowI[j] against throughK + rowK[j] for j in [begin, end). throughK must
+// be finite; an infinite rowK[j] never wins, which keeps the textbook semantics
+// without a branch per cell. Sums wrap like the vector lanes do. nextI may be
+// null when successors are not tracked.
+template <typename Dist>
+struct MinPlus {
+    typedef void (*Kernel)(Dist* rowI, int* nextI, const Dist* rowK, Dist throughK, int firstHop, int begin, int end);
+};
+
+template <typename Dist>
+struct RelaxKernelInfo {
+    const char* name;
+    typename MinPlus<Dist>::Kernel kernel;
+};
+
+template <typename Dist>
+inline Dist wrappingAdd(Dist a, Dist b) {
+    typedef typename std::make_unsigned<Dist>::type Unsigned;
+    return static_cast<Dist>(static_cast<Unsigned>(static_cast<Unsigned>(a) + static_cast<Unsigned>(b)));
+}
+
+template <typename Dist>
+inline void relaxScalar(Dist* rowI, int* nextI, const Dist* rowK, Dist throughK, int firstHop, int begin, int end) {
+    const Dist inf = std::numeric_limits<Dist>::max();
+    if (!nextI) {
+        for (int j = begin; j < end; ++j) {
+            Dist candidate = rowK[j] == inf ? inf : wrappingAdd(throughK, rowK[j]);
+            rowI[j] = candidate < rowI[j] ? candidate : rowI[j];
+        }
+        return;
+    }
+    for (int j = begin; j < end; ++j) {
+        Dist candidate = rowK[j] == inf ? inf : wrappingAdd(throughK, rowK[j]);
+        bool better = candidate < rowI[j];
+        rowI[j] = better ? candidate : rowI[j];
+        nextI[j] = better ? firstHop : nextI[j];
+    }
+}
+
+#ifdef MINPLUS_X86
+
+__attribute__((target("sse4.1")))
+inline void relaxSse41(int16_t* rowI, int* nextI, const int16_t* rowK, int16_t throughK, int firstHop, int begin, int end) {
+    const __m128i inf = _mm_set1_epi16(std::numeric_limits<int16_t>::max());
+    const __m128i through = _mm_set1_epi16(throughK);
+    const __m128i hop = _mm_set1_epi32(firstHop);
+    int j = begin;
+    for (; j + 8 <= end; j += 8) {
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowK + j));
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowI + j));
+        __m128i candidate = _mm_blendv_epi8(_mm_add_epi16(through, k), inf, _mm_cmpeq_epi16(k, inf));
+        __m128i better = _mm_cmpgt_epi16(current, candidate);
+        if (_mm_testz_si128(better, better)) continue;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rowI + j), _mm_min_epi16(current, candidate));
+        if (!nextI) continue;
+        __m128i* next = reinterpret_cast<__m128i*>(nextI + j);
+        _mm_storeu_si128(next, _mm_blendv_epi8(_mm_loadu_si128(next), hop, _mm_cvtepi16_epi32(better)));
+        _mm_storeu_si128(next + 1, _mm_blendv_epi8(_mm_loadu_si128(next + 1), hop,
+                                                   _mm_cvtepi16_epi32(_mm_srli_si128(better, 8))));
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+__attribute__((target("sse4.1")))
+inline void relaxSse41(int32_t* rowI, int* nextI, const int32_t* rowK, int32_t throughK, int firstHop, int begin, int end) {
+    const __m128i inf = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+    const __m128i through = _mm_set1_epi32(throughK);
+    const __m128i hop = _mm_set1_epi32(firstHop);
+    int j = begin;
+    for (; j + 4 <= end; j += 4) {
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowK + j));
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowI + j));
+        __m128i candidate = _mm_blendv_epi8(_mm_add_epi32(through, k), inf, _mm_cmpeq_epi32(k, inf));
+        __m128i better = _mm_cmpgt_epi32(current, candidate);
+        if (_mm_testz_si128(better, better)) continue;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rowI + j), _mm_min_epi32(current, candidate));
+        if (!nextI) continue;
+        __m128i* next = reinterpret_cast<__m128i*>(nextI + j);
+        _mm_storeu_si128(next, _mm_blendv_epi8(_mm_loadu_si128(next), hop, better));
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+__attribute__((target("avx2")))
+inline void relaxAvx2(int16_t* rowI, int* nextI, const int16_t* rowK, int16_t throughK, int firstHop, int begin, int end) {
+    const __m256i inf = _mm256_set1_epi16(std::numeric_limits<int16_t>::max());
+    const __m256i through = _mm256_set1_epi16(throughK);
+    const __m256i hop = _mm256_set1_epi32(firstHop);
+    int j = begin;
+    for (; j + 16 <= end; j += 16) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowK + j));
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowI + j));
+        __m256i candidate = _mm256_blendv_epi8(_mm256_add_epi16(through, k), inf, _mm256_cmpeq_epi16(k, inf));
+        __m256i better = _mm256_cmpgt_epi16(current, candidate);
+        if (_mm256_testz_si256(better, better)) continue;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rowI + j), _mm256_min_epi16(current, candidate));
+        if (!nextI) continue;
+        __m256i* next = reinterpret_cast<__m256i*>(nextI + j);
+        __m256i low = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(better));
+        __m256i high = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(better, 1));
+        _mm256_storeu_si256(next, _mm256_blendv_epi8(_mm256_loadu_si256(next), hop, low));
+        _mm256_storeu_si256(next + 1, _mm256_blendv_epi8(_mm256_loadu_si256(next + 1), hop, high));
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+__attribute__((target("avx2")))
+inline void relaxAvx2(int32_t* rowI, int* nextI, const int32_t* rowK, int32_t throughK, int firstHop, int begin, int end) {
+    const __m256i inf = _mm256_set1_epi32(std::numeric_limits<int32_t>::max());
+    const __m256i through = _mm256_set1_epi32(throughK);
+    const __m256i hop = _mm256_set1_epi32(firstHop);
+    int j = begin;
+    for (; j + 8 <= end; j += 8) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowK + j));
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowI + j));
+        __m256i candidate = _mm256_blendv_epi8(_mm256_add_epi32(through, k), inf, _mm256_cmpeq_epi32(k, inf));
+        __m256i better = _mm256_cmpgt_epi32(current, candidate);
+        if (_mm256_testz_si256(better, better)) continue;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rowI + j), _mm256_min_epi32(current, candidate));
+        if (!nextI) continue;
+        __m256i* next = reinterpret_cast<__m256i*>(nextI + j);
+        _mm256_storeu_si256(next, _mm256_blendv_epi8(_mm256_loadu_si256(next), hop, better));
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+__attribute__((target("avx2")))
+inline void relaxAvx2(int64_t* rowI, int* nextI, const int64_t* rowK, int64_t throughK, int firstHop, int begin, int end) {
+    const __m256i inf = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+    const __m256i through = _mm256_set1_epi64x(throughK);
+    const __m128i hop = _mm_set1_epi32(firstHop);
+    const __m256i evenLanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    int j = begin;
+    for (; j + 4 <= end; j += 4) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowK + j));
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowI + j));
+        __m256i candidate = _mm256_blendv_epi8(_mm256_add_epi64(through, k), inf, _mm256_cmpeq_epi64(k, inf));
+        __m256i better = _mm256_cmpgt_epi64(current, candidate);
+        if (_mm256_testz_si256(better, better)) continue;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rowI + j), _mm256_blendv_epi8(current, candidate, better));
+        if (!nextI) continue;
+        __m128i mask = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(better, evenLanes));
+        __m128i* next = reinterpret_cast<__m128i*>(nextI + j);
+        _mm_storeu_si128(next, _mm_blendv_epi8(_mm_loadu_si128(next), hop, mask));
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline void relaxAvx512(int16_t* rowI, int* nextI, const int16_t* rowK, int16_t throughK, int firstHop, int begin, int end) {
+    const __m512i inf = _mm512_set1_epi16(std::numeric_limits<int16_t>::max());
+    const __m512i through = _mm512_set1_epi16(throughK);
+    const __m512i hop = _mm512_set1_epi32(firstHop);
+    int j = begin;
+    for (; j + 32 <= end; j += 32) {
+        __m512i k = _mm512_loadu_si512(rowK + j);
+        __m512i current = _mm512_loadu_si512(rowI + j);
+        __mmask32 finite = _mm512_cmpneq_epi16_mask(k, inf);
+        __m512i candidate = _mm512_mask_add_epi16(inf, finite, through, k);
+        __mmask32 better = _mm512_cmpgt_epi16_mask(current, candidate);
+        if (!better) continue;
+        _mm512_mask_storeu_epi16(rowI + j, better, candidate);
+        if (!nextI) continue;
+        _mm512_mask_storeu_epi32(nextI + j, static_cast<__mmask16>(better), hop);
+        _mm512_mask_storeu_epi32(nextI + j + 16, static_cast<__mmask16>(better >> 16), hop);
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+__attribute__((target("avx512f")))
+inline void relaxAvx512(int32_t* rowI, int* nextI, const int32_t* rowK, int32_t throughK, int firstHop, int begin, int end) {
+    const __m512i inf = _mm512_set1_epi32(std::numeric_limits<int32_t>::max());
+    const __m512i through = _mm512_set1_epi32(throughK);
+    const __m512i hop = _mm512_set1_epi32(firstHop);
+    int j = begin;
+    for (; j + 16 <= end; j += 16) {
+        __m512i k = _mm512_loadu_si512(rowK + j);
+        __m512i current = _mm512_loadu_si512(rowI + j);
+        __mmask16 finite = _mm512_cmpneq_epi32_mask(k, inf);
+        __m512i candidate = _mm512_mask_add_epi32(inf, finite, through, k);
+        __mmask16 better = _mm512_cmpgt_epi32_mask(current, candidate);
+        if (!better) continue;
+        _mm512_mask_storeu_epi32(rowI + j, better, candidate);
+        if (nextI) _mm512_mask_storeu_epi32(nextI + j, better, hop);
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+__attribute__((target("avx512f")))
+inline void relaxAvx512(int64_t* rowI, int* nextI, const int64_t* rowK, int64_t throughK, int firstHop, int begin, int end) {
+    const __m512i inf = _mm512_set1_epi64(std::numeric_limits<int64_t>::max());
+    const __m512i through = _mm512_set1_epi64(throughK);
+    const __m512i hop = _mm512_set1_epi32(firstHop);
+    int j = begin;
+    for (; j + 8 <= end; j += 8) {
+        __m512i k = _mm512_loadu_si512(rowK + j);
+        __m512i current = _mm512_loadu_si512(rowI + j);
+        __mmask8 finite = _mm512_cmpneq_epi64_mask(k, inf);
+        __m512i candidate = _mm512_mask_add_epi64(inf, finite, through, k);
+        __mmask8 better = _mm512_cmpgt_epi64_mask(current, candidate);
+        if (!better) continue;
+        _mm512_mask_storeu_epi64(rowI + j, better, candidate);
+        if (nextI) _mm512_mask_storeu_epi32(nextI + j, static_cast<__mmask16>(better), hop);
+    }
+    relaxScalar(rowI, nextI, rowK, throughK, firstHop, j, end);
+}
+
+template <typename Dist>
+inline typename MinPlus<Dist>::Kernel sse41Kernel() { return relaxSse41; }
+
+template <>
+inline MinPlus<int64_t>::Kernel sse41Kernel<int64_t>() { return nullptr; }
+
+#endif
+
+template <typename Dist>
+inline int availableRelaxKernels(RelaxKernelInfo<Dist>* kernels) {
+    int count = 0;
+    kernels[count++] = RelaxKernelInfo<Dist>{"scalar", relaxScalar<Dist>};
+#ifdef MINPLUS_X86
+    __builtin_cpu_init();
+    bool narrow = sizeof(Dist) == sizeof(int16_t);
+    if (sse41Kernel<Dist>() && __builtin_cpu_supports("sse4.1")) {
+        kernels[count++] = RelaxKernelInfo<Dist>{"sse4.1", sse41Kernel<Dist>()};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels[count++] = RelaxKernelInfo<Dist>{"avx2", relaxAvx2};
+    }
+    if (__builtin_cpu_supports("avx512f") && (!narrow || __builtin_cpu_supports("avx512bw"))) {
+        kernels[count++] = RelaxKernelInfo<Dist>{"avx512", relaxAvx512};
+    }
+#endif
+    return count;
+}
+
+template <typename Dist>
+inline RelaxKernelInfo<Dist> selectRelaxKernel(const std::string& requested) {
+    RelaxKernelInfo<Dist> kernels[4];
+    int count = availableRelaxKernels(kernels);
+    if (requested.empty()) return kernels[count - 1];
+    for (int i = 0; i < count; ++i) {
+        if (requested == kernels[i].name) return kernels[i];
+    }
+    return RelaxKernelInfo<Dist>{nullptr, nullptr};
+}
+
+#endif
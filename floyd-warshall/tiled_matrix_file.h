@@ -0,0 +1,192 @@
+#ifndef GRAFOS_TILED_MATRIX_FILE_H
+#define GRAFOS_TILED_MATRIX_FILE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Disk-backed V x V matrix stored tile-major: tile (ib, jb) is a contiguous
+// run of tileSize*tileSize cells, so a tile is one sequential read or write.
+// Only `capacity` tiles stay mapped in at a time; the rest are handed back to
+// the page cache. completedBlocks is the per-k-block checkpoint. A fresh file
+// only gets its magic and inputHash with the first checkpoint, once every
+// tile has been initialized, so an interrupted initialization never resumes.
+const char TILED_MATRIX_MAGIC[8] = {'A', 'P', 'S', 'P', 'T', 'I', 'L', 'E'};
+const uint32_t TILED_MATRIX_VERSION = 1;
+const size_t TILED_MATRIX_DATA_OFFSET = 4096;
+
+struct TiledMatrixHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertices;
+    uint32_t tileSize;
+    uint32_t distanceBytes;
+    uint32_t completedBlocks;
+    uint32_t padding;
+    uint64_t inputHash;
+};
+
+template <typename Dist>
+class TiledMatrixFile {
+private:
+    int fd;
+    char* mapping;
+    size_t mappingSize;
+    TiledMatrixHeader* header;
+    int blocks;
+    size_t tileCells;
+    size_t capacity;
+    std::list<int> recentlyUsed;
+    std::vector<std::list<int>::iterator> position;
+    std::vector<char> resident;
+    std::vector<char> dirty;
+    unsigned long long bytesRead;
+    unsigned long long bytesEvicted;
+    unsigned long long bytesCheckpointed;
+    int checkpoints;
+    uint64_t pendingHash;
+
+    Dist* tileAddress(int id) {
+        return reinterpret_cast<Dist*>(mapping + TILED_MATRIX_DATA_OFFSET) + static_cast<size_t>(id) * tileCells;
+    }
+
+    // A dirty tile stays dirty once evicted: its pages only went back to the
+    // page cache, and the next checkpoint still has to sync them.
+    void release(int id) {
+        size_t tileBytes = tileCells * sizeof(Dist);
+        if (dirty[id]) bytesEvicted += tileBytes;
+        madvise(tileAddress(id), tileBytes, MADV_DONTNEED);
+        resident[id] = 0;
+    }
+
+public:
+    TiledMatrixFile()
+        : fd(-1), mapping(nullptr), mappingSize(0), header(nullptr), blocks(0), tileCells(0), capacity(0),
+          bytesRead(0), bytesEvicted(0), bytesCheckpointed(0), checkpoints(0), pendingHash(0) {}
+
+    ~TiledMatrixFile() {
+        if (mapping) {
+            msync(mapping, mappingSize, MS_SYNC);
+            munmap(mapping, mappingSize);
+        }
+        if (fd >= 0) close(fd);
+    }
+
+    // Opens an existing checkpoint when it matches (vertices, tileSize, type,
+    // inputHash); otherwise creates a fresh file. Returns false on I/O errors.
+    bool open(const std::string& path, int vertices, int tileSize, uint64_t inputHash, size_t cacheBytes, bool& resumed) {
+        blocks = (vertices + tileSize - 1) / tileSize;
+        tileCells = static_cast<size_t>(tileSize) * tileSize;
+        size_t tileCount = static_cast<size_t>(blocks) * blocks;
+        mappingSize = TILED_MATRIX_DATA_OFFSET + tileCount * tileCells * sizeof(Dist);
+        capacity = std::max<size_t>(3, cacheBytes / (tileCells * sizeof(Dist)));
+
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) return false;
+
+        resumed = false;
+        if (static_cast<size_t>(info.st_size) == mappingSize) {
+            TiledMatrixHeader existing;
+            if (pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+                std::memcmp(existing.magic, TILED_MATRIX_MAGIC, sizeof(existing.magic)) == 0 &&
+                existing.version == TILED_MATRIX_VERSION && existing.vertices == static_cast<uint32_t>(vertices) &&
+                existing.tileSize == static_cast<uint32_t>(tileSize) && existing.distanceBytes == sizeof(Dist) &&
+                existing.inputHash == inputHash) {
+                resumed = true;
+            }
+        }
+        if (!resumed && (ftruncate(fd, 0) != 0 || ftruncate(fd, static_cast<off_t>(mappingSize)) != 0)) {
+            return false;
+        }
+
+        void* address = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) return false;
+        mapping = static_cast<char*>(address);
+        header = reinterpret_cast<TiledMatrixHeader*>(mapping);
+        if (!resumed) {
+            std::memset(header, 0, sizeof(TiledMatrixHeader));
+            header->version = TILED_MATRIX_VERSION;
+            header->vertices = static_cast<uint32_t>(vertices);
+            header->tileSize = static_cast<uint32_t>(tileSize);
+            header->distanceBytes = sizeof(Dist);
+            pendingHash = inputHash;
+        }
+
+        position.assign(tileCount, recentlyUsed.end());
+        resident.assign(tileCount, 0);
+        dirty.assign(tileCount, 0);
+        return true;
+    }
+
+    int blockCount() const { return blocks; }
+    int completedBlocks() const { return static_cast<int>(header->completedBlocks); }
+
+    Dist* tile(int ib, int jb, bool modify) {
+        int id = ib * blocks + jb;
+        if (resident[id]) {
+            recentlyUsed.erase(position[id]);
+        } else {
+            if (recentlyUsed.size() >= capacity) {
+                int victim = recentlyUsed.back();
+                recentlyUsed.pop_back();
+                position[victim] = recentlyUsed.end();
+                release(victim);
+            }
+            resident[id] = 1;
+            bytesRead += tileCells * sizeof(Dist);
+        }
+        recentlyUsed.push_front(id);
+        position[id] = recentlyUsed.begin();
+        if (modify) dirty[id] = 1;
+        return tileAddress(id);
+    }
+
+    // Every tile modified since the last checkpoint, resident or evicted,
+    // reaches the disk before the block counter moves, so a restart never
+    // skips work that was not persisted. Tiles the kernel wrote back on its
+    // own hold distances relaxed further than the counter records; they are
+    // still lengths of real paths, so redoing those k-blocks over them gives
+    // the same result.
+    void checkpoint(int completed) {
+        for (size_t id = 0; id < dirty.size(); ++id) {
+            if (dirty[id]) {
+                msync(tileAddress(static_cast<int>(id)), tileCells * sizeof(Dist), MS_SYNC);
+                bytesCheckpointed += tileCells * sizeof(Dist);
+                dirty[id] = 0;
+            }
+        }
+        ++checkpoints;
+        header->completedBlocks = static_cast<uint32_t>(completed);
+        if (std::memcmp(header->magic, TILED_MATRIX_MAGIC, sizeof(header->magic)) != 0) {
+            header->inputHash = pendingHash;
+            std::memcpy(header->magic, TILED_MATRIX_MAGIC, sizeof(header->magic));
+        }
+        msync(mapping, TILED_MATRIX_DATA_OFFSET, MS_SYNC);
+    }
+
+    void dropAll() {
+        for (int id : recentlyUsed) {
+            release(id);
+            position[id] = recentlyUsed.end();
+        }
+        recentlyUsed.clear();
+    }
+
+    unsigned long long readVolume() const { return bytesRead; }
+    // Modified tiles handed back to the page cache on eviction, and tiles
+    // synced to disk by checkpoints (evicted ones included).
+    unsigned long long evictedVolume() const { return bytesEvicted; }
+    unsigned long long checkpointVolume() const { return bytesCheckpointed; }
+    int checkpointCount() const { return checkpoints; }
+};
+
+#endif
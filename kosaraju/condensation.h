@@ -0,0 +1,248 @@
+#ifndef GRAFOS_CONDENSATION_H
+#define GRAFOS_CONDENSATION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Condensation of a digraph: one node per SCC, numbered in topological order
+// so every DAG edge goes from a smaller id to a larger one.
+//
+// "--condensation" file: CondensationHeader, then uint32 component[V] at
+// componentOffset, the DAG as CSR with uint64 offsets[C + 1] at
+// offsetsOffset and uint32 targets[dagEdges] at targetsOffset.
+//
+// "--reach-index" file: ReachabilityHeader, then uint32 component[V] at
+// componentOffset and the transitive closure at rowsOffset: C rows of
+// wordsPerRow uint64 words, bit d of row c set when c reaches d.
+const char CONDENSATION_MAGIC[4] = {'S', 'C', 'C', 'D'};
+const char REACHABILITY_MAGIC[4] = {'S', 'C', 'C', 'R'};
+const uint32_t CONDENSATION_VERSION = 1;
+
+struct CondensationHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertices;
+    uint32_t components;
+    uint64_t dagEdges;
+    uint64_t componentOffset;
+    uint64_t offsetsOffset;
+    uint64_t targetsOffset;
+};
+
+struct ReachabilityHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertices;
+    uint32_t components;
+    uint64_t wordsPerRow;
+    uint64_t componentOffset;
+    uint64_t rowsOffset;
+};
+
+struct Condensation {
+    std::vector<uint32_t> component;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> targets;
+
+    int components() const { return static_cast<int>(offsets.size()) - 1; }
+};
+
+// labels holds any non-negative id per vertex, equal within a component.
+// Adjacency must provide begin(v), end(v) and target(e).
+template <typename Adjacency>
+Condensation condense(const Adjacency& edges, int vertices, const std::vector<int>& labels) {
+    int labelCount = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end()) + 1;
+    std::vector<int> dense(labelCount, -1);
+    int components = 0;
+    std::vector<int> component(vertices);
+    for (int v = 0; v < vertices; v++) {
+        if (dense[labels[v]] < 0) dense[labels[v]] = components++;
+        component[v] = dense[labels[v]];
+    }
+    std::vector<int>().swap(dense);
+
+    // Members grouped per component, then each component's distinct
+    // successors; seen[d] == c marks d as already listed for c.
+    std::vector<int> memberStart(components + 1, 0);
+    for (int v = 0; v < vertices; v++) ++memberStart[component[v] + 1];
+    for (int c = 0; c < components; c++) memberStart[c + 1] += memberStart[c];
+    std::vector<int> members(vertices);
+    std::vector<int> fill(memberStart.begin(), memberStart.end() - 1);
+    for (int v = 0; v < vertices; v++) members[fill[component[v]]++] = v;
+
+    std::vector<uint64_t> offsets(components + 1, 0);
+    std::vector<uint32_t> targets;
+    std::vector<int> seen(components, -1);
+    std::vector<int> inDegree(components, 0);
+    for (int c = 0; c < components; c++) {
+        for (int k = memberStart[c]; k < memberStart[c + 1]; k++) {
+            int u = members[k];
+            for (int e = edges.begin(u); e < edges.end(u); e++) {
+                int d = component[edges.target(e)];
+                if (d == c || seen[d] == c) continue;
+                seen[d] = c;
+                targets.push_back(d);
+                ++inDegree[d];
+            }
+        }
+        offsets[c + 1] = targets.size();
+    }
+
+    // Kahn's algorithm gives the topological ids.
+    std::vector<int> order;
+    order.reserve(components);
+    for (int c = 0; c < components; c++) {
+        if (inDegree[c] == 0) order.push_back(c);
+    }
+    for (size_t k = 0; k < order.size(); k++) {
+        int c = order[k];
+        for (uint64_t e = offsets[c]; e < offsets[c + 1]; e++) {
+            if (--inDegree[targets[e]] == 0) order.push_back(targets[e]);
+        }
+    }
+    std::vector<int> position(components);
+    for (int k = 0; k < components; k++) position[order[k]] = k;
+
+    Condensation result;
+    result.component.resize(vertices);
+    for (int v = 0; v < vertices; v++) result.component[v] = position[component[v]];
+    result.offsets.assign(components + 1, 0);
+    result.targets.resize(targets.size());
+    for (int k = 0; k < components; k++) {
+        int c = order[k];
+        uint64_t begin = result.offsets[k];
+        for (uint64_t e = offsets[c]; e < offsets[c + 1]; e++) {
+            result.targets[begin + (e - offsets[c])] = position[targets[e]];
+        }
+        result.offsets[k + 1] = begin + (offsets[c + 1] - offsets[c]);
+        std::sort(result.targets.begin() + begin, result.targets.begin() + result.offsets[k + 1]);
+    }
+    return result;
+}
+
+inline uint64_t alignTo8(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+inline bool writeCondensation(const std::string& path, const Condensation& dag) {
+    CondensationHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CONDENSATION_MAGIC, 4);
+    header.version = CONDENSATION_VERSION;
+    header.vertices = static_cast<uint32_t>(dag.component.size());
+    header.components = static_cast<uint32_t>(dag.components());
+    header.dagEdges = dag.targets.size();
+    header.componentOffset = sizeof(header);
+    header.offsetsOffset = alignTo8(header.componentOffset + dag.component.size() * sizeof(uint32_t));
+    header.targetsOffset = header.offsetsOffset + dag.offsets.size() * sizeof(uint64_t);
+
+    std::ofstream out(path, std::ios::binary);
+    const char padding[8] = {0};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(dag.component.data()), dag.component.size() * sizeof(uint32_t));
+    out.write(padding, header.offsetsOffset - header.componentOffset - dag.component.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(dag.offsets.data()), dag.offsets.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(dag.targets.data()), dag.targets.size() * sizeof(uint32_t));
+    return static_cast<bool>(out);
+}
+
+inline uint64_t reachabilityBytes(const Condensation& dag) {
+    uint64_t words = (static_cast<uint64_t>(dag.components()) + 63) / 64;
+    return static_cast<uint64_t>(dag.components()) * words * sizeof(uint64_t);
+}
+
+// Rows are filled from the last topological id down: every successor's row
+// is final by then and is ORed in a word at a time.
+inline bool writeReachabilityIndex(const std::string& path, const Condensation& dag) {
+    uint64_t components = dag.components();
+    uint64_t words = (components + 63) / 64;
+    std::vector<uint64_t> rows(components * words, 0);
+    for (uint64_t c = components; c-- > 0;) {
+        uint64_t* row = &rows[c * words];
+        row[c / 64] |= uint64_t(1) << (c % 64);
+        for (uint64_t e = dag.offsets[c]; e < dag.offsets[c + 1]; e++) {
+            const uint64_t* successor = &rows[dag.targets[e] * words];
+            // Ids below c + 1 can never be reached from c.
+            for (uint64_t w = (c + 1) / 64; w < words; w++) row[w] |= successor[w];
+        }
+    }
+
+    ReachabilityHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, REACHABILITY_MAGIC, 4);
+    header.version = CONDENSATION_VERSION;
+    header.vertices = static_cast<uint32_t>(dag.component.size());
+    header.components = static_cast<uint32_t>(components);
+    header.wordsPerRow = words;
+    header.componentOffset = sizeof(header);
+    header.rowsOffset = alignTo8(header.componentOffset + dag.component.size() * sizeof(uint32_t));
+
+    std::ofstream out(path, std::ios::binary);
+    const char padding[8] = {0};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(dag.component.data()), dag.component.size() * sizeof(uint32_t));
+    out.write(padding, header.rowsOffset - header.componentOffset - dag.component.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(rows.data()), rows.size() * sizeof(uint64_t));
+    return static_cast<bool>(out);
+}
+
+// Read-only mmap of a reachability index; reaches() is two lookups and a
+// bit test.
+class ReachabilityIndexView {
+private:
+    void* mapping;
+    size_t mappingSize;
+    const ReachabilityHeader* header;
+    const uint32_t* component;
+    const uint64_t* rows;
+
+public:
+    ReachabilityIndexView() : mapping(MAP_FAILED), mappingSize(0), header(nullptr), component(nullptr), rows(nullptr) {}
+
+    ~ReachabilityIndexView() {
+        if (mapping != MAP_FAILED) munmap(mapping, mappingSize);
+    }
+
+    bool open(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ReachabilityHeader)) {
+            close(fd);
+            return false;
+        }
+        mappingSize = static_cast<size_t>(info.st_size);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) return false;
+
+        header = static_cast<const ReachabilityHeader*>(mapping);
+        uint64_t rowBytes = static_cast<uint64_t>(header->components) * header->wordsPerRow * sizeof(uint64_t);
+        if (std::memcmp(header->magic, REACHABILITY_MAGIC, 4) != 0 || header->version != CONDENSATION_VERSION ||
+            header->componentOffset + static_cast<uint64_t>(header->vertices) * sizeof(uint32_t) > mappingSize ||
+            header->rowsOffset + rowBytes > mappingSize) {
+            return false;
+        }
+        const char* base = static_cast<const char*>(mapping);
+        component = reinterpret_cast<const uint32_t*>(base + header->componentOffset);
+        rows = reinterpret_cast<const uint64_t*>(base + header->rowsOffset);
+        return true;
+    }
+
+    int vertices() const { return static_cast<int>(header->vertices); }
+
+    // u and v are 0-based vertices.
+    bool reaches(int u, int v) const {
+        uint64_t from = component[u];
+        uint64_t to = component[v];
+        return (rows[from * header->wordsPerRow + to / 64] >> (to % 64)) & 1;
+    }
+};
+
+#endif
@@ -1,73 +1,451 @@
 #include <iostream>
 #include <vector>
-#include <list>
 #include <fstream>
 #include <string>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
 
-class DirectedGraph {
+#include "task_pool.h"
+#include "condensation.h"
+#include "graph_reader.h"
+#include "graph_snapshot.h"
+#include "output_writer.h"
+
+// Compressed adjacency: the successors of v are targets[offsets[v] ..
+// offsets[v + 1]), kept in the order the edges were read. The views point at
+// the vectors or into a mapped directed snapshot, whose 1-based arrays are
+// read one slot ahead and shifted back by one.
+class CsrAdjacency {
 private:
-    int verticesCount;
-    std::vector<std::list<int>> edges;
-    std::vector<std::list<int>> transposedEdges;
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    const int* offsetView = nullptr;
+    const int* targetView = nullptr;
+    int shift = 0;
 
 public:
-    DirectedGraph(int numVertices) : verticesCount(numVertices) {
-        edges.resize(numVertices);
-        transposedEdges.resize(numVertices);
+    void build(int vertices, const std::vector<int>& from, const std::vector<int>& to) {
+        offsets.assign(vertices + 1, 0);
+        for (int u : from) ++offsets[u + 1];
+        for (int v = 0; v < vertices; ++v) offsets[v + 1] += offsets[v];
+        targets.resize(from.size());
+        std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < from.size(); ++e) targets[fill[from[e]]++] = to[e];
+        offsetView = offsets.data();
+        targetView = targets.data();
+        shift = 0;
     }
 
-    void insertEdge(int from, int to) {
-        edges[from].push_back(to);
-        transposedEdges[to].push_back(from);
+    void attach(const int* snapshotOffsets, const int* snapshotTargets) {
+        offsetView = snapshotOffsets + 1;
+        targetView = snapshotTargets;
+        shift = 1;
     }
 
-    void firstDFS(int node, std::vector<bool>& visited, std::vector<int>& finishOrder) {
+    int begin(int v) const { return offsetView[v]; }
+    int end(int v) const { return offsetView[v + 1]; }
+    int target(int e) const { return targetView[e] - shift; }
+};
+
+// Components are written through one OutputWriter, which reaches the file
+// (and the console, when echoed) in large blocks. In canonical form every
+// component lists its vertices in increasing order and components follow
+// their smallest vertex, so any two engines can be compared line by line;
+// components are then only labelled as they arrive and written by finish().
+// Labels are also kept when the condensation is requested.
+class ComponentWriter {
+private:
+    OutputWriter out;
+    bool canonical;
+    bool keepLabels;
+    std::vector<int> label;
+    int labelCount;
+
+    void append(const int* members, size_t count) {
+        for (size_t j = 0; j < count; j++) {
+            out.putInteger(members[j]);
+            if (j < count - 1) out.put(' ');
+        }
+        out.put('\n');
+    }
+
+public:
+    ComponentWriter(std::ofstream& outFile, bool echo, int vertices, bool canonicalOrder, bool labelled)
+        : out(&outFile, echo), canonical(canonicalOrder), keepLabels(canonicalOrder || labelled), labelCount(0) {
+        if (keepLabels) label.assign(vertices, -1);
+    }
+
+    // members are 1-based vertex numbers.
+    void write(const int* members, size_t count) {
+        if (!canonical) append(members, count);
+        if (!keepLabels) return;
+        for (size_t j = 0; j < count; j++) label[members[j] - 1] = labelCount;
+        ++labelCount;
+    }
+
+    // Takes one non-negative label per 0-based vertex, equal within a
+    // component; only meaningful in canonical form or with labels kept.
+    void writeLabels(std::vector<int>& labels) {
+        label.swap(labels);
+        labelCount = label.empty() ? 0 : *std::max_element(label.begin(), label.end()) + 1;
+    }
+
+    const std::vector<int>& labels() const { return label; }
+
+    void finish() {
+        if (!canonical) {
+            out.flush();
+            return;
+        }
+        int vertices = static_cast<int>(label.size());
+        std::vector<int> rank(labelCount, -1);
+        int components = 0;
+        for (int v = 0; v < vertices; v++) {
+            if (rank[label[v]] < 0) rank[label[v]] = components++;
+        }
+        std::vector<int> start(components + 1, 0);
+        for (int v = 0; v < vertices; v++) ++start[rank[label[v]] + 1];
+        for (int c = 0; c < components; c++) start[c + 1] += start[c];
+        std::vector<int> members(vertices);
+        std::vector<int> fill(start.begin(), start.end() - 1);
+        for (int v = 0; v < vertices; v++) members[fill[rank[label[v]]]++] = v + 1;
+        for (int c = 0; c < components; c++) append(&members[start[c]], start[c + 1] - start[c]);
+        out.flush();
+    }
+};
+
+// Both DFS passes keep an explicit stack of (vertex, next edge) frames, so
+// long chains no longer overflow the call stack; vertices are visited in the
+// same order the recursive version used.
+class DirectedGraph {
+private:
+    int verticesCount;
+    std::vector<int> edgeFrom;
+    std::vector<int> edgeTo;
+    CsrAdjacency edges;
+    CsrAdjacency transposedEdges;
+
+    void firstDFS(int node, std::vector<bool>& visited, std::vector<int>& finishOrder,
+                  std::vector<std::pair<int, int>>& stack) {
         visited[node] = true;
-        for (int next : edges[node]) {
+        stack.emplace_back(node, edges.begin(node));
+        while (!stack.empty()) {
+            int current = stack.back().first;
+            int& cursor = stack.back().second;
+            if (cursor == edges.end(current)) {
+                finishOrder.push_back(current);
+                stack.pop_back();
+                continue;
+            }
+            int next = edges.target(cursor++);
             if (!visited[next]) {
-                firstDFS(next, visited, finishOrder);
+                visited[next] = true;
+                stack.emplace_back(next, edges.begin(next));
             }
         }
-        finishOrder.push_back(node);
     }
 
-    void secondDFS(int node, std::vector<bool>& visited, std::vector<int>& component) {
+    void secondDFS(int node, std::vector<bool>& visited, std::vector<int>& component,
+                   std::vector<std::pair<int, int>>& stack) {
         visited[node] = true;
         component.push_back(node + 1);
-        for (int next : transposedEdges[node]) {
+        stack.emplace_back(node, transposedEdges.begin(node));
+        while (!stack.empty()) {
+            int current = stack.back().first;
+            int& cursor = stack.back().second;
+            if (cursor == transposedEdges.end(current)) {
+                stack.pop_back();
+                continue;
+            }
+            int next = transposedEdges.target(cursor++);
             if (!visited[next]) {
-                secondDFS(next, visited, component);
+                visited[next] = true;
+                component.push_back(next + 1);
+                stack.emplace_back(next, transposedEdges.begin(next));
+            }
+        }
+    }
+
+    static const int TRIMMED = -1;
+    static const size_t PARALLEL_GRAIN = 2048;
+
+    // Level-synchronous search over `adjacency` from source; claim(w)
+    // atomically moves w into the search and says whether it did.
+    template <typename Claim>
+    void reach(TaskPool& pool, const CsrAdjacency& adjacency, int source, const Claim& claim) {
+        std::vector<int> frontier(1, source), next;
+        std::mutex nextMutex;
+        while (!frontier.empty()) {
+            next.clear();
+            pool.parallelFor(frontier.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+                std::vector<int> found;
+                for (size_t k = begin; k < end; k++) {
+                    int v = frontier[k];
+                    for (int e = adjacency.begin(v); e < adjacency.end(v); e++) {
+                        if (claim(adjacency.target(e))) found.push_back(adjacency.target(e));
+                    }
+                }
+                std::lock_guard<std::mutex> lock(nextMutex);
+                next.insert(next.end(), found.begin(), found.end());
+            });
+            frontier.swap(next);
+        }
+    }
+
+    // Repeatedly removes vertices without incoming or outgoing edges among the
+    // survivors; each is a component by itself. Returns the survivors.
+    std::shared_ptr<std::vector<int>> trim(TaskPool& pool, std::atomic<int>* color) {
+        std::unique_ptr<std::atomic<int>[]> inDegree(new std::atomic<int>[verticesCount]);
+        std::unique_ptr<std::atomic<int>[]> outDegree(new std::atomic<int>[verticesCount]);
+        std::vector<int> frontier, next;
+        for (int v = 0; v < verticesCount; v++) {
+            inDegree[v].store(transposedEdges.end(v) - transposedEdges.begin(v), std::memory_order_relaxed);
+            outDegree[v].store(edges.end(v) - edges.begin(v), std::memory_order_relaxed);
+            if (inDegree[v] == 0 || outDegree[v] == 0) {
+                color[v].store(TRIMMED, std::memory_order_relaxed);
+                frontier.push_back(v);
             }
         }
+        auto claim = [&](int w) {
+            int expected = 0;
+            return color[w].compare_exchange_strong(expected, TRIMMED);
+        };
+        std::mutex nextMutex;
+        while (!frontier.empty()) {
+            next.clear();
+            pool.parallelFor(frontier.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+                std::vector<int> found;
+                for (size_t k = begin; k < end; k++) {
+                    int v = frontier[k];
+                    for (int e = edges.begin(v); e < edges.end(v); e++) {
+                        int w = edges.target(e);
+                        if (--inDegree[w] == 0 && claim(w)) found.push_back(w);
+                    }
+                    for (int e = transposedEdges.begin(v); e < transposedEdges.end(v); e++) {
+                        int w = transposedEdges.target(e);
+                        if (--outDegree[w] == 0 && claim(w)) found.push_back(w);
+                    }
+                }
+                std::lock_guard<std::mutex> lock(nextMutex);
+                next.insert(next.end(), found.begin(), found.end());
+            });
+            frontier.swap(next);
+        }
+
+        std::shared_ptr<std::vector<int>> remaining(new std::vector<int>());
+        for (int v = 0; v < verticesCount; v++) {
+            if (color[v].load(std::memory_order_relaxed) == 0) remaining->push_back(v);
+        }
+        return remaining;
+    }
+
+    void splitPartition(TaskPool& pool, std::atomic<int>* color, std::atomic<int>& nextColor,
+                        std::shared_ptr<std::vector<int>> members, int partition) {
+        int pivot = members->front();
+        int forwardColor = nextColor++;
+        int componentColor = nextColor++;
+        int backwardColor = nextColor++;
+        if (members->size() == 1) {
+            color[pivot].store(componentColor, std::memory_order_relaxed);
+            return;
+        }
+
+        color[pivot].store(forwardColor, std::memory_order_relaxed);
+        reach(pool, edges, pivot, [&](int w) {
+            int expected = partition;
+            return color[w].compare_exchange_strong(expected, forwardColor);
+        });
+        color[pivot].store(componentColor, std::memory_order_relaxed);
+        reach(pool, transposedEdges, pivot, [&](int w) {
+            int expected = forwardColor;
+            if (color[w].compare_exchange_strong(expected, componentColor)) return true;
+            expected = partition;
+            return color[w].compare_exchange_strong(expected, backwardColor);
+        });
+
+        std::shared_ptr<std::vector<int>> forwardOnly(new std::vector<int>());
+        std::shared_ptr<std::vector<int>> backwardOnly(new std::vector<int>());
+        std::shared_ptr<std::vector<int>> neither(new std::vector<int>());
+        for (int v : *members) {
+            int c = color[v].load(std::memory_order_relaxed);
+            if (c == forwardColor) forwardOnly->push_back(v);
+            else if (c == backwardColor) backwardOnly->push_back(v);
+            else if (c == partition) neither->push_back(v);
+        }
+        members.reset();
+
+        const std::pair<std::shared_ptr<std::vector<int>>, int> parts[] = {
+            std::make_pair(forwardOnly, forwardColor), std::make_pair(backwardOnly, backwardColor),
+            std::make_pair(neither, partition)};
+        for (const auto& part : parts) {
+            if (part.first->empty()) continue;
+            std::shared_ptr<std::vector<int>> list = part.first;
+            int listColor = part.second;
+            pool.spawn([this, &pool, color, &nextColor, list, listColor] {
+                splitPartition(pool, color, nextColor, list, listColor);
+            });
+        }
     }
 
-    void computeSCCs(std::ofstream& outFile) {
+public:
+    DirectedGraph(int numVertices) : verticesCount(numVertices) {}
+
+    void insertEdge(int from, int to) {
+        if (from < 0 || to < 0 || from >= verticesCount || to >= verticesCount) return;
+        edgeFrom.push_back(from);
+        edgeTo.push_back(to);
+    }
+
+    // Takes over the 1-based edges as read, dropping those outside the graph
+    // in place instead of copying them.
+    void adoptEdges(EdgeRecords<int>& records) {
+        size_t kept = 0;
+        for (size_t e = 0; e < records.size(); e++) {
+            int from = records.from[e] - 1, to = records.to[e] - 1;
+            if (from < 0 || to < 0 || from >= verticesCount || to >= verticesCount) continue;
+            records.from[kept] = from;
+            records.to[kept] = to;
+            ++kept;
+        }
+        records.from.resize(kept);
+        records.to.resize(kept);
+        edgeFrom.swap(records.from);
+        edgeTo.swap(records.to);
+    }
+
+    // Tarjan only walks forward edges, so the transpose is built on demand.
+    void freeze(bool withTranspose) {
+        edges.build(verticesCount, edgeFrom, edgeTo);
+        if (withTranspose) transposedEdges.build(verticesCount, edgeTo, edgeFrom);
+        std::vector<int>().swap(edgeFrom);
+        std::vector<int>().swap(edgeTo);
+    }
+
+    // A directed snapshot already holds both adjacencies; an undirected one
+    // is read as its edge list, like the text file it came from.
+    void attach(const GraphSnapshot& snapshot, bool withTranspose) {
+        if (!snapshot.directed()) {
+            for (long long e = 0; e < snapshot.edgeCount(); e++) {
+                insertEdge(snapshot.edgeFrom()[e] - 1, snapshot.edgeTo()[e] - 1);
+            }
+            freeze(withTranspose);
+            return;
+        }
+        edges.attach(snapshot.offsets(), snapshot.targets());
+        if (withTranspose) transposedEdges.attach(snapshot.reverseOffsets(), snapshot.reverseTargets());
+    }
+
+    Condensation buildCondensation(const std::vector<int>& labels) const {
+        return condense(edges, verticesCount, labels);
+    }
+
+    void computeSCCs(ComponentWriter& writer) {
         std::vector<bool> visited(verticesCount, false);
         std::vector<int> finishOrder;
+        std::vector<std::pair<int, int>> stack;
+        finishOrder.reserve(verticesCount);
 
         for (int i = 0; i < verticesCount; i++) {
             if (!visited[i]) {
-                firstDFS(i, visited, finishOrder);
+                firstDFS(i, visited, finishOrder, stack);
             }
         }
 
         visited.assign(verticesCount, false);
+        std::vector<int> component;
 
-        for (int i = finishOrder.size() - 1; i >= 0; i--) {
+        for (int i = static_cast<int>(finishOrder.size()) - 1; i >= 0; i--) {
             int v = finishOrder[i];
             if (!visited[v]) {
-                std::vector<int> component;
-                secondDFS(v, visited, component);
-                for (size_t j = 0; j < component.size(); j++) {
-                    std::cout << component[j];
-                    outFile << component[j];
-                    if (j < component.size() - 1) {
-                        std::cout << " ";
-                        outFile << " ";
+                component.clear();
+                secondDFS(v, visited, component, stack);
+                writer.write(component.data(), component.size());
+            }
+        }
+    }
+
+    // Trim, then forward-backward: the vertices that a pivot reaches and that
+    // reach it form its component, and what only one search (or neither)
+    // reached cannot share a component with the rest, so the three leftovers
+    // are split again as independent tasks. A vertex's color names the
+    // partition it is in; searches only claim vertices of their own color.
+    void computeSCCsParallel(ComponentWriter& writer, int threads) {
+        TaskPool pool(threads);
+        std::unique_ptr<std::atomic<int>[]> color(new std::atomic<int>[verticesCount]);
+        std::atomic<int> nextColor(1);
+        for (int v = 0; v < verticesCount; v++) color[v].store(0, std::memory_order_relaxed);
+
+        pool.run([&] {
+            std::shared_ptr<std::vector<int>> remaining = trim(pool, color.get());
+            if (!remaining->empty()) splitPartition(pool, color.get(), nextColor, remaining, 0);
+        });
+
+        // Trimmed vertices are singletons; they get labels past every color.
+        int firstFree = nextColor.load();
+        std::vector<int> labels(verticesCount);
+        for (int v = 0; v < verticesCount; v++) {
+            int c = color[v].load(std::memory_order_relaxed);
+            labels[v] = c == TRIMMED ? firstFree + v : c;
+        }
+        writer.writeLabels(labels);
+    }
+
+    // Tarjan's single pass: index[v] is the DFS discovery number and low[v]
+    // the smallest index reachable through v's subtree and one back edge.
+    // A vertex whose low equals its index closes a component, which is popped
+    // off the vertex stack; components come out in reverse topological order.
+    void computeSCCsTarjan(ComponentWriter& writer) {
+        const int unvisited = -1;
+        std::vector<int> index(verticesCount, unvisited);
+        std::vector<int> low(verticesCount);
+        std::vector<bool> onStack(verticesCount, false);
+        std::vector<int> vertexStack;
+        std::vector<std::pair<int, int>> callStack;
+        std::vector<int> component;
+        int counter = 0;
+
+        for (int root = 0; root < verticesCount; root++) {
+            if (index[root] != unvisited) continue;
+            index[root] = low[root] = counter++;
+            vertexStack.push_back(root);
+            onStack[root] = true;
+            callStack.emplace_back(root, edges.begin(root));
+
+            while (!callStack.empty()) {
+                int current = callStack.back().first;
+                int& cursor = callStack.back().second;
+                if (cursor < edges.end(current)) {
+                    int next = edges.target(cursor++);
+                    if (index[next] == unvisited) {
+                        index[next] = low[next] = counter++;
+                        vertexStack.push_back(next);
+                        onStack[next] = true;
+                        callStack.emplace_back(next, edges.begin(next));
+                    } else if (onStack[next]) {
+                        low[current] = std::min(low[current], index[next]);
                     }
+                    continue;
+                }
+
+                callStack.pop_back();
+                if (!callStack.empty()) {
+                    int parent = callStack.back().first;
+                    low[parent] = std::min(low[parent], low[current]);
+                }
+                if (low[current] == index[current]) {
+                    component.clear();
+                    int member;
+                    do {
+                        member = vertexStack.back();
+                        vertexStack.pop_back();
+                        onStack[member] = false;
+                        component.push_back(member + 1);
+                    } while (member != current);
+                    writer.write(component.data(), component.size());
                 }
-                std::cout << std::endl;
-                outFile << std::endl;
             }
         }
     }
@@ -76,12 +454,54 @@ public:
 void displayHelp() {
     std::cout << "-h : mostra o help\n";
     std::cout << "-o <arquivo> : redireciona a saida para o arquivo\n";
+    std::cout << "--echo : repete a saída no console (por padrão ela só vai para o arquivo)\n";
     std::cout << "-f <arquivo> : indica o arquivo que contém o grafo de entrada\n";
+    std::cout << "--algo <kosaraju|tarjan|parallel> : tarjan encontra as componentes numa única passada, sem o grafo transposto;\n";
+    std::cout << "    parallel poda vértices triviais e divide o resto por alcance para frente e para trás\n";
+    std::cout << "--threads <n> : threads do modo parallel (padrão: todos os núcleos)\n";
+    std::cout << "--canonical : cada componente em ordem crescente, componentes pelo menor vértice (sempre ativo em parallel)\n";
+    std::cout << "--condensation <arquivo> : grava o DAG das componentes em binário (componente de cada vértice, em ordem\n";
+    std::cout << "    topológica, e as arestas entre componentes sem repetição)\n";
+    std::cout << "--reach-index <arquivo> : grava o fecho transitivo do DAG como bitsets (componentes^2 bits)\n";
+    std::cout << "--reach <indice> <pares> : responde 'u v' por linha com um índice gravado por --reach-index (dispensa -f)\n";
+    std::cout << "--convert <snapshot> : grava o grafo lido num snapshot binário (CSR e transposto), aceito por -f\n";
+}
+
+// One "u->v: sim|não" line per pair, through the same writer the components
+// use.
+int answerReachability(const std::string& indexFile, const std::string& pairsFile, OutputWriter& out) {
+    ReachabilityIndexView index;
+    if (!index.open(indexFile.c_str())) {
+        std::cerr << "Índice de alcance inválido: " << indexFile << "\n";
+        return 1;
+    }
+    std::ifstream pairs(pairsFile);
+    if (!pairs) {
+        std::cerr << "Erro ao abrir o arquivo de pares: " << pairsFile << "\n";
+        return 1;
+    }
+    int u, v;
+    while (pairs >> u >> v) {
+        if (u < 1 || v < 1 || u > index.vertices() || v > index.vertices()) {
+            std::cerr << "Par fora do grafo: " << u << " " << v << "\n";
+            return 1;
+        }
+        out.putInteger(u);
+        out.put("->");
+        out.putInteger(v);
+        out.put(index.reaches(u - 1, v - 1) ? ": sim\n" : ": não\n");
+    }
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
     std::string inputFile, outputFile = "output.bin";
     bool showHelp = false;
+    std::string algorithm = "kosaraju";
+    bool canonical = false;
+    bool echo = false;
+    int threads = 0;
+    std::string condensationFile, reachIndexFile, reachQueryIndex, reachPairsFile, convertFile;
 
     for (int i = 1; i < argc; i++) {
         if (std::string(argv[i]) == "-h") {
@@ -90,6 +510,27 @@ int main(int argc, char* argv[]) {
             inputFile = argv[++i];
         } else if (std::string(argv[i]) == "-o" && i + 1 < argc) {
             outputFile = argv[++i];
+        } else if (std::string(argv[i]) == "--canonical") {
+            canonical = true;
+        } else if (std::string(argv[i]) == "--echo") {
+            echo = true;
+        } else if (std::string(argv[i]) == "--threads" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--condensation" && i + 1 < argc) {
+            condensationFile = argv[++i];
+        } else if (std::string(argv[i]) == "--reach-index" && i + 1 < argc) {
+            reachIndexFile = argv[++i];
+        } else if (std::string(argv[i]) == "--reach" && i + 2 < argc) {
+            reachQueryIndex = argv[++i];
+            reachPairsFile = argv[++i];
+        } else if (std::string(argv[i]) == "--convert" && i + 1 < argc) {
+            convertFile = argv[++i];
+        } else if (std::string(argv[i]) == "--algo" && i + 1 < argc) {
+            algorithm = argv[++i];
+            if (algorithm != "kosaraju" && algorithm != "tarjan" && algorithm != "parallel") {
+                std::cerr << "Algoritmo desconhecido: " << algorithm << "\n";
+                return 1;
+            }
         }
     }
 
@@ -98,16 +539,46 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    if (!reachQueryIndex.empty()) {
+        std::ofstream outFile(outputFile);
+        if (!outFile) {
+            std::cerr << "Erro ao abrir o arquivo de saída: " << outputFile << "\n";
+            return 1;
+        }
+        OutputWriter out(&outFile, echo);
+        return answerReachability(reachQueryIndex, reachPairsFile, out);
+    }
+
     if (inputFile.empty()) {
         std::cerr << "Arquivos de entrada não especificados.\n";
         return 1;
     }
 
-    std::ifstream inFile(inputFile);
-    if (!inFile) {
+    GraphFileReader inFile;
+    GraphSnapshot snapshot;
+    bool fromSnapshot = GraphSnapshot::isSnapshot(inputFile);
+    if (fromSnapshot ? !snapshot.open(inputFile) : !inFile.open(inputFile)) {
         std::cerr << "Erro ao abrir o arquivo de entrada: " << inputFile << "\n";
         return 1;
     }
+    if (fromSnapshot && !convertFile.empty()) {
+        std::cerr << "A entrada já é um snapshot: " << inputFile << "\n";
+        return 1;
+    }
+
+    if (!convertFile.empty()) {
+        int V = 0, E = 0;
+        inFile.read(V);
+        inFile.read(E);
+        EdgeRecords<int> records;
+        inFile.readEdges(E, EdgeWeight::None, V, threads, records);
+        std::string error;
+        if (!writeGraphSnapshot<int>(convertFile, V, records.from, records.to, nullptr, true, error)) {
+            std::cerr << "Erro ao gravar o snapshot " << convertFile << ": " << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
     std::ofstream outFile(outputFile);
     if (!outFile) {
@@ -115,19 +586,57 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    int V, E;
-    inFile >> V >> E;
+    int V = 0, E = 0;
+    if (fromSnapshot) {
+        V = snapshot.vertices();
+    } else {
+        inFile.read(V);
+        inFile.read(E);
+    }
     DirectedGraph graph(V);
-
-    for (int i = 0; i < E; i++) {
-        int u, v;
-        inFile >> u >> v;
-        graph.insertEdge(u - 1, v - 1);
+    if (fromSnapshot) {
+        graph.attach(snapshot, algorithm != "tarjan");
+    } else {
+        EdgeRecords<int> records;
+        inFile.readEdges(E, EdgeWeight::None, V, threads, records);
+        graph.adoptEdges(records);
+        graph.freeze(algorithm != "tarjan");
     }
-
-    inFile.close();
-    graph.computeSCCs(outFile);
+    bool condensed = !condensationFile.empty() || !reachIndexFile.empty();
+    ComponentWriter writer(outFile, echo, V, canonical || algorithm == "parallel", condensed);
+    if (algorithm == "tarjan") {
+        graph.computeSCCsTarjan(writer);
+    } else if (algorithm == "parallel") {
+        graph.computeSCCsParallel(writer, threads);
+    } else {
+        graph.computeSCCs(writer);
+    }
+    writer.finish();
     outFile.close();
 
+    if (condensed) {
+        Condensation dag = graph.buildCondensation(writer.labels());
+        std::cerr << "Condensação: " << dag.components() << " componentes, " << dag.targets.size()
+                  << " arestas no DAG\n";
+        if (!condensationFile.empty() && !writeCondensation(condensationFile, dag)) {
+            std::cerr << "Erro ao gravar a condensação: " << condensationFile << "\n";
+            return 1;
+        }
+        if (!reachIndexFile.empty()) {
+            uint64_t bytes = reachabilityBytes(dag);
+            uint64_t memory = static_cast<uint64_t>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE);
+            if (bytes > memory / 2) {
+                std::cerr << "Índice de alcance exigiria " << (bytes >> 20) << " MB para " << dag.components()
+                          << " componentes; não gerado.\n";
+                return 1;
+            }
+            if (!writeReachabilityIndex(reachIndexFile, dag)) {
+                std::cerr << "Erro ao gravar o índice de alcance: " << reachIndexFile << "\n";
+                return 1;
+            }
+            std::cerr << "Índice de alcance: " << (bytes >> 20) << " MB\n";
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
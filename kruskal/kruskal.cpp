@@ -1,8 +1,17 @@
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <fstream>
 #include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "worker_pool.h"
+#include "graph_reader.h"
+#include "graph_snapshot.h"
+#include "output_writer.h"
 
 class DisjointSet {
 private:
@@ -25,6 +34,12 @@ public:
         return parent[x];
     }
 
+    // Root lookup without path compression, safe while several threads read.
+    int peekRoot(int x) const {
+        while (parent[x] != x) x = parent[x];
+        return x;
+    }
+
     void unite(int x, int y) {
         int rootX = findRoot(x);
         int rootY = findRoot(y);
@@ -40,101 +55,423 @@ public:
     }
 };
 
+// Edges in struct-of-arrays form, sorted once by weight. Each key holds the
+// biased weight in its high half and the edge index in its low half; the
+// radix sort only orders the high half and is stable, so equal weights keep
+// their input order. The endpoints are read through views, which point at
+// the vectors or into a mapped snapshot's edge list.
+class EdgeList {
+private:
+    std::vector<int> from;
+    std::vector<int> to;
+    std::vector<uint64_t> keys;
+    const int* fromView;
+    const int* toView;
+
+    static const int DIGIT_BITS = 16;
+    static const size_t DIGITS = size_t(1) << DIGIT_BITS;
+
+    static uint64_t key(int w, size_t index) {
+        uint64_t biased = static_cast<uint32_t>(w) ^ 0x80000000u;
+        return biased << 32 | static_cast<uint64_t>(index);
+    }
+
+public:
+    EdgeList() : fromView(nullptr), toView(nullptr) {}
+
+    EdgeList(const EdgeList&) = delete;
+    EdgeList& operator=(const EdgeList&) = delete;
+
+    void reserve(size_t count) {
+        from.reserve(count);
+        to.reserve(count);
+        keys.reserve(count);
+    }
+
+    void add(int u, int v, int w) {
+        keys.push_back(key(w, from.size()));
+        from.push_back(u);
+        to.push_back(v);
+        fromView = from.data();
+        toView = to.data();
+    }
+
+    // Uses a snapshot's edge list in place; only the keys are built.
+    void attach(const int* sources, const int* targets, const int* weights, size_t count) {
+        keys.resize(count);
+        for (size_t e = 0; e < count; ++e) keys[e] = key(weights[e], e);
+        fromView = sources;
+        toView = targets;
+    }
+
+    size_t size() const { return keys.size(); }
+    size_t bytes() const { return from.capacity() * sizeof(int) + to.capacity() * sizeof(int) + keys.capacity() * sizeof(uint64_t); }
+
+    // LSD radix sort over the two 16-bit digits of the weight. Each lane
+    // counts and then scatters its own contiguous slice, so the passes run in
+    // parallel and stay stable; a digit shared by every edge is skipped.
+    void sortByWeight(WorkerPool& pool) {
+        size_t count = keys.size();
+        int lanes = pool.size();
+        std::vector<uint64_t> scratch(count);
+        std::vector<std::vector<size_t>> histogram(lanes, std::vector<size_t>(DIGITS));
+        for (int shift = 32; shift < 64; shift += DIGIT_BITS) {
+            pool.parallelFor(lanes, [&](int lane) {
+                std::vector<size_t>& counts = histogram[lane];
+                std::fill(counts.begin(), counts.end(), 0);
+                for (size_t k = count * lane / lanes; k < count * (lane + 1) / lanes; ++k) {
+                    ++counts[(keys[k] >> shift) & (DIGITS - 1)];
+                }
+            });
+            size_t offset = 0;
+            bool trivial = false;
+            for (size_t digit = 0; digit < DIGITS; ++digit) {
+                size_t total = 0;
+                for (int lane = 0; lane < lanes; ++lane) {
+                    size_t laneCount = histogram[lane][digit];
+                    histogram[lane][digit] = offset + total;
+                    total += laneCount;
+                }
+                if (total == count) trivial = true;
+                offset += total;
+            }
+            if (trivial) continue;
+            pool.parallelFor(lanes, [&](int lane) {
+                std::vector<size_t>& next = histogram[lane];
+                for (size_t k = count * lane / lanes; k < count * (lane + 1) / lanes; ++k) {
+                    scratch[next[(keys[k] >> shift) & (DIGITS - 1)]++] = keys[k];
+                }
+            });
+            keys.swap(scratch);
+        }
+    }
+
+    // Keys are unique, so ordering them is a strict total order on the edges:
+    // every engine below ends up with the same tree.
+    std::vector<uint64_t>& getKeys() { return keys; }
+
+    int source(uint64_t key) const { return fromView[static_cast<uint32_t>(key)]; }
+    int target(uint64_t key) const { return toView[static_cast<uint32_t>(key)]; }
+    static int weight(uint64_t key) { return static_cast<int>(static_cast<uint32_t>(key >> 32) ^ 0x80000000u); }
+};
+
+// Lock-free counterpart of DisjointSet for Borůvka: parents are swapped with
+// compare-and-swap, finds halve paths instead of compressing them, and the
+// larger root always goes under the smaller one, so concurrent unions can
+// never close a cycle.
+class ConcurrentDisjointSet {
+private:
+    std::unique_ptr<std::atomic<int>[]> parent;
+
+public:
+    ConcurrentDisjointSet(int n) : parent(new std::atomic<int>[n + 1]) {
+        for (int i = 0; i <= n; ++i) {
+            parent[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    int findRoot(int x) {
+        while (true) {
+            int p = parent[x].load(std::memory_order_acquire);
+            if (p == x) return x;
+            int grandparent = parent[p].load(std::memory_order_acquire);
+            if (p != grandparent) parent[x].compare_exchange_weak(p, grandparent, std::memory_order_release);
+            x = grandparent;
+        }
+    }
+
+    // False when x and y were already in the same set.
+    bool unite(int x, int y) {
+        while (true) {
+            x = findRoot(x);
+            y = findRoot(y);
+            if (x == y) return false;
+            if (x < y) std::swap(x, y);
+            int expected = x;
+            if (parent[x].compare_exchange_strong(expected, y, std::memory_order_acq_rel)) return true;
+        }
+    }
+};
+
 class GraphNetwork {
 private:
     int nodes;
-    std::vector<std::vector<std::pair<int, int>>> adjList;
     std::vector<std::pair<std::pair<int, int>, int>> mstEdges;
 
 public:
     GraphNetwork(int n) : nodes(n) {
-        adjList.resize(n + 1);
-    }
-
-    void addEdge(int u, int v, int w) {
-        adjList[u].emplace_back(v, w);
-        adjList[v].emplace_back(u, w);
+        mstEdges.reserve(n > 0 ? n - 1 : 0);
     }
 
     void addToMST(int s, int e, int w) {
         mstEdges.emplace_back(std::make_pair(s, e), w);
     }
 
-    std::vector<std::pair<std::pair<int, int>, int>> getMSTEdges() const {
+    const std::vector<std::pair<std::pair<int, int>, int>>& getMSTEdges() const {
         return mstEdges;
     }
 
-    std::vector<std::vector<std::pair<int, int>>> getAdjList() const {
-        return adjList;
+    bool isSpanning() const {
+        return static_cast<int>(mstEdges.size()) >= nodes - 1;
     }
 };
 
+const size_t PARALLEL_GRAIN = 1 << 14;
+const size_t FILTER_KRUSKAL_BASE = 1 << 16;
+const int VERTEX_CHUNK = 4096;
+
+// Keeps the keys for which keep(key) holds, in order: each lane compacts its
+// own slice in place, then the slices are joined.
+template <typename Keep>
+size_t compactKeys(WorkerPool& pool, uint64_t* keys, size_t count, const Keep& keep) {
+    int lanes = count < PARALLEL_GRAIN ? 1 : pool.size();
+    std::vector<size_t> kept(lanes);
+    pool.parallelFor(lanes, [&](int lane) {
+        size_t begin = count * lane / lanes, write = begin;
+        for (size_t k = begin; k < count * (lane + 1) / lanes; ++k) {
+            if (keep(keys[k])) keys[write++] = keys[k];
+        }
+        kept[lane] = write - begin;
+    });
+    size_t total = 0;
+    for (int lane = 0; lane < lanes; ++lane) {
+        size_t begin = count * lane / lanes;
+        std::copy(keys + begin, keys + begin + kept[lane], keys + total);
+        total += kept[lane];
+    }
+    return total;
+}
+
+// Kruskal's scan over keys already in order; returns how many it examined
+// before the tree spanned.
+size_t scanInOrder(const EdgeList& edgeList, const uint64_t* keys, size_t count, DisjointSet& ds,
+                   GraphNetwork& graph) {
+    size_t scanned = 0;
+    for (; scanned < count && !graph.isSpanning(); ++scanned) {
+        int u = edgeList.source(keys[scanned]);
+        int v = edgeList.target(keys[scanned]);
+        if (ds.findRoot(u) != ds.findRoot(v)) {
+            graph.addToMST(u, v, EdgeList::weight(keys[scanned]));
+            ds.unite(u, v);
+        }
+    }
+    return scanned;
+}
+
+// Filter-Kruskal: split around a pivot, solve the light side, then drop
+// heavy edges whose endpoints it already joined before recursing on them.
+// Small ranges are sorted and scanned directly.
+void filterKruskal(const EdgeList& edgeList, uint64_t* keys, size_t count, DisjointSet& ds, GraphNetwork& graph,
+                   WorkerPool& pool, size_t& examined) {
+    if (count == 0 || graph.isSpanning()) return;
+    if (count <= FILTER_KRUSKAL_BASE) {
+        std::sort(keys, keys + count);
+        examined += scanInOrder(edgeList, keys, count, ds, graph);
+        return;
+    }
+    uint64_t samples[3] = {keys[0], keys[count / 2], keys[count - 1]};
+    std::sort(samples, samples + 3);
+    uint64_t pivot = samples[1];
+    uint64_t* heavy = std::partition(keys, keys + count, [&](uint64_t key) { return key <= pivot; });
+    filterKruskal(edgeList, keys, heavy - keys, ds, graph, pool, examined);
+    if (graph.isSpanning()) return;
+    size_t heavyCount = keys + count - heavy;
+    examined += heavyCount;
+    heavyCount = compactKeys(pool, heavy, heavyCount, [&](uint64_t key) {
+        return ds.peekRoot(edgeList.source(key)) != ds.peekRoot(edgeList.target(key));
+    });
+    filterKruskal(edgeList, heavy, heavyCount, ds, graph, pool, examined);
+}
+
+// Borůvka rounds: every component picks its lightest crossing edge with an
+// atomic min on the key, the picks are united concurrently, and edges left
+// inside a component are dropped. Picks are listed in key order at the end,
+// so -s prints the tree exactly as Kruskal would.
+void boruvka(EdgeList& edgeList, int vertices, GraphNetwork& graph, WorkerPool& pool, size_t& examined) {
+    const uint64_t none = ~uint64_t(0);
+    ConcurrentDisjointSet ds(vertices);
+    std::unique_ptr<std::atomic<uint64_t>[]> lightest(new std::atomic<uint64_t>[vertices + 1]);
+    std::vector<uint64_t>& keys = edgeList.getKeys();
+    size_t alive = keys.size();
+    std::vector<std::vector<uint64_t>> picked(pool.size());
+    std::vector<uint64_t> tree;
+
+    auto offer = [&](int root, uint64_t key) {
+        uint64_t seen = lightest[root].load(std::memory_order_relaxed);
+        while (key < seen && !lightest[root].compare_exchange_weak(seen, key, std::memory_order_relaxed)) {
+        }
+    };
+
+    while (true) {
+        for (int v = 0; v <= vertices; ++v) lightest[v].store(none, std::memory_order_relaxed);
+        examined += alive;
+        alive = compactKeys(pool, keys.data(), alive, [&](uint64_t key) {
+            int ru = ds.findRoot(edgeList.source(key));
+            int rv = ds.findRoot(edgeList.target(key));
+            if (ru == rv) return false;
+            offer(ru, key);
+            offer(rv, key);
+            return true;
+        });
+        if (alive == 0) break;
+
+        int lanes = static_cast<size_t>(vertices) < PARALLEL_GRAIN ? 1 : pool.size();
+        std::atomic<int> nextVertex(1);
+        pool.parallelFor(lanes, [&](int lane) {
+            for (int begin = nextVertex.fetch_add(VERTEX_CHUNK); begin <= vertices;
+                 begin = nextVertex.fetch_add(VERTEX_CHUNK)) {
+                for (int v = begin; v < begin + VERTEX_CHUNK && v <= vertices; ++v) {
+                    uint64_t key = lightest[v].load(std::memory_order_relaxed);
+                    if (key != none && ds.unite(edgeList.source(key), edgeList.target(key))) {
+                        picked[lane].push_back(key);
+                    }
+                }
+            }
+        });
+        for (auto& lanePicks : picked) {
+            tree.insert(tree.end(), lanePicks.begin(), lanePicks.end());
+            lanePicks.clear();
+        }
+    }
+
+    std::sort(tree.begin(), tree.end());
+    for (uint64_t key : tree) {
+        graph.addToMST(edgeList.source(key), edgeList.target(key), EdgeList::weight(key));
+    }
+}
+
 void showUsage() {
     std::cout << "-h : mostra o help\n";
     std::cout << "-o <arquivo> : redireciona a saída para o arquivo\n";
+    std::cout << "--echo : repete a saída no console (por padrão ela só vai para o arquivo)\n";
     std::cout << "-f <arquivo> : indica o arquivo que contém o grafo de entrada\n";
     std::cout << "-s : mostra a solução\n";
     std::cout << "-i : vértice inicial (não usado para Kruskal, mas suportado)\n";
+    std::cout << "--algo <kruskal|filter-kruskal|boruvka> : algoritmo da árvore (padrão kruskal)\n";
+    std::cout << "--threads <n> : threads da ordenação, do filtro ou do Borůvka (0 usa todos os núcleos)\n";
+    std::cout << "--stats : mostra tempos de leitura, ordenação e varredura e a memória das arestas\n";
+    std::cout << "--convert <snapshot> : grava o grafo lido num snapshot binário, aceito por -f\n";
 }
 
-void processGraph(const std::string& inputFile, const std::string& outputFile, bool displaySolution) {
-    std::ifstream in(inputFile);
-    std::ofstream out(outputFile);
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void processGraph(const std::string& inputFile, const std::string& outputFile, bool displaySolution,
+                  const std::string& algorithm, int threads, bool showStats, const std::string& convertFile,
+                  bool echo) {
+    GraphFileReader in;
+    GraphSnapshot snapshot;
+    bool fromSnapshot = GraphSnapshot::isSnapshot(inputFile);
+    if (fromSnapshot ? !snapshot.open(inputFile) : !in.open(inputFile)) {
+        std::cerr << "Erro ao abrir arquivos.\n";
+        return;
+    }
+    if (fromSnapshot && !convertFile.empty()) {
+        std::cerr << "A entrada já é um snapshot.\n";
+        return;
+    }
+
+    if (!convertFile.empty()) {
+        int vertices = 0, edges = 0;
+        in.read(vertices);
+        in.read(edges);
+        EdgeRecords<int> records;
+        in.readEdges(edges, EdgeWeight::Required, vertices, threads, records);
+        std::string error;
+        if (!writeGraphSnapshot(convertFile, vertices, records.from, records.to, &records.weight, false, error)) {
+            std::cerr << "Erro ao gravar o snapshot " << convertFile << ": " << error << "\n";
+        }
+        return;
+    }
 
-    if (!in || !out) {
+    std::ofstream out(outputFile);
+    if (!out) {
         std::cerr << "Erro ao abrir arquivos.\n";
         return;
     }
 
-    int vertices, edges;
-    in >> vertices >> edges;
+    auto start = std::chrono::steady_clock::now();
+    int vertices = 0, edges = 0;
+    if (fromSnapshot) {
+        vertices = snapshot.vertices();
+    } else {
+        in.read(vertices);
+        in.read(edges);
+    }
 
     GraphNetwork graph(vertices);
-    auto cmp = [](const std::pair<std::pair<int, int>, int>& a, const std::pair<std::pair<int, int>, int>& b) { return a.second > b.second; };
-    std::priority_queue<std::pair<std::pair<int, int>, int>, std::vector<std::pair<std::pair<int, int>, int>>, decltype(cmp)> edgeQueue(cmp);
+    EdgeList edgeList;
+    std::vector<int> snapshotWeights;
+    if (fromSnapshot) {
+        const int* weights = snapshot.edgeWeights(snapshotWeights);
+        if (!weights) {
+            std::cerr << "Pesos do snapshot não cabem em int.\n";
+            return;
+        }
+        edgeList.attach(snapshot.edgeFrom(), snapshot.edgeTo(), weights, snapshot.edgeCount());
+    } else {
+        EdgeRecords<int> records;
+        in.readEdges(edges, EdgeWeight::Required, vertices, threads, records);
+        edgeList.reserve(records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            int u = records.from[i], v = records.to[i];
+            if (u < 1 || v < 1 || u > vertices || v > vertices) continue;
+            edgeList.add(u, v, records.weight[i]);
+        }
+    }
+    double readSeconds = secondsSince(start);
 
-    for (int i = 0; i < edges; ++i) {
-        int u, v, w;
-        in >> u >> v >> w;
-        graph.addEdge(u, v, w);
-        edgeQueue.emplace(std::make_pair(u, v), w);
+    size_t edgeCount = edgeList.size();
+    size_t memory = edgeList.bytes();
+    size_t examined = 0;
+    WorkerPool pool(threads);
+    start = std::chrono::steady_clock::now();
+    if (algorithm == "boruvka") {
+        boruvka(edgeList, vertices, graph, pool, examined);
+    } else if (algorithm == "filter-kruskal") {
+        DisjointSet ds(vertices);
+        filterKruskal(edgeList, edgeList.getKeys().data(), edgeCount, ds, graph, pool, examined);
+    } else {
+        edgeList.sortByWeight(pool);
+        if (showStats) std::cerr << "Ordenação: " << secondsSince(start) << " s\n";
+        DisjointSet ds(vertices);
+        examined = scanInOrder(edgeList, edgeList.getKeys().data(), edgeCount, ds, graph);
     }
+    double treeSeconds = secondsSince(start);
 
-    DisjointSet ds(vertices);
-    int totalWeight = 0;
+    long long totalWeight = 0;
+    for (const auto& edge : graph.getMSTEdges()) {
+        totalWeight += edge.second;
+    }
 
-    while (!edgeQueue.empty()) {
-        auto edge = edgeQueue.top();
-        edgeQueue.pop();
-        int u = edge.first.first;
-        int v = edge.first.second;
-        int w = edge.second;
-        if (ds.findRoot(u) != ds.findRoot(v)) {
-            graph.addToMST(u, v, w);
-            ds.unite(u, v);
-            totalWeight += w;
-        }
+    if (showStats) {
+        std::cerr << "Leitura: " << readSeconds << " s, " << algorithm << ": " << treeSeconds << " s (" << examined
+                  << " arestas examinadas de " << edgeCount << "), arestas em memória: "
+                  << memory / (1024.0 * 1024.0) << " MB\n";
     }
 
+    OutputWriter writer(&out, echo);
     if (displaySolution) {
         for (const auto& edge : graph.getMSTEdges()) {
-            out << "(" << edge.first.first << "," << edge.first.second << ") ";
-            std::cout << "(" << edge.first.first << "," << edge.first.second << ") ";
+            writer.put('(');
+            writer.putInteger(edge.first.first);
+            writer.put(',');
+            writer.putInteger(edge.first.second);
+            writer.put(") ");
         }
-        std::cout << "\n";
-        out << "\n";
+        writer.put('\n');
     } else {
-        out << totalWeight;
-        std::cout << totalWeight;
+        writer.putInteger(totalWeight);
     }
-
-    in.close();
-    out.close();
 }
 
 int main(int argc, char* argv[]) {
     std::string inFile, outFile = "output.bin";
-    bool showSol = false, showHelp = false;
+    bool showSol = false, showHelp = false, showStats = false, echo = false;
+    int threads = 1;
+    std::string algorithm = "kruskal";
+    std::string convertFile;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg(argv[i]);
@@ -146,6 +483,20 @@ int main(int argc, char* argv[]) {
             outFile = argv[++i];
         } else if (arg == "-s") {
             showSol = true;
+        } else if (arg == "--echo") {
+            echo = true;
+        } else if (arg == "--algo" && i + 1 < argc) {
+            algorithm = argv[++i];
+            if (algorithm != "kruskal" && algorithm != "filter-kruskal" && algorithm != "boruvka") {
+                std::cerr << "Algoritmo desconhecido: " << algorithm << "\n";
+                return 1;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--convert" && i + 1 < argc) {
+            convertFile = argv[++i];
         }
     }
 
@@ -159,6 +510,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    processGraph(inFile, outFile, showSol);
+    processGraph(inFile, outFile, showSol, algorithm, threads, showStats, convertFile, echo);
     return 0;
 }
\ No newline at end of file
@@ -1,124 +1,360 @@
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <fstream>
 #include <string>
 #include <limits>
+#include <algorithm>
 
-struct EdgeInfo {
-    int vertex;
-    int weight;
-    EdgeInfo(int v, int w) : vertex(v), weight(w) {}
-};
+#include "graph_reader.h"
+#include "graph_snapshot.h"
+#include "output_writer.h"
 
-class UndirectedGraph {
+// Indexed 4-ary min-heap over vertices: position[v] locates v, so lowering
+// a key sifts it up in place and the heap never holds more than V entries.
+class IndexedHeap {
 private:
-    int vertexCount;
-    std::vector<std::vector<EdgeInfo>> adjList;
+    static const int ARITY = 4;
+    std::vector<int> heap;
+    std::vector<int> position;
+    std::vector<int> key;
+
+    void place(int index, int vertex) {
+        heap[index] = vertex;
+        position[vertex] = index;
+    }
+
+    void siftUp(int index) {
+        int vertex = heap[index];
+        while (index > 0) {
+            int parent = (index - 1) / ARITY;
+            if (key[heap[parent]] <= key[vertex]) break;
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, vertex);
+    }
+
+    void siftDown(int index) {
+        int vertex = heap[index];
+        int size = static_cast<int>(heap.size());
+        while (true) {
+            int first = index * ARITY + 1;
+            if (first >= size) break;
+            int best = first;
+            int last = std::min(first + ARITY, size);
+            for (int child = first + 1; child < last; ++child) {
+                if (key[heap[child]] < key[heap[best]]) best = child;
+            }
+            if (key[vertex] <= key[heap[best]]) break;
+            place(index, heap[best]);
+            index = best;
+        }
+        place(index, vertex);
+    }
 
 public:
-    UndirectedGraph(int vertices) : vertexCount(vertices) {
-        adjList.resize(vertices);
+    IndexedHeap(int vertices) : position(vertices, -1), key(vertices) {}
+
+    bool empty() const { return heap.empty(); }
+
+    // Inserts vertex or lowers its key.
+    void push(int vertex, int newKey) {
+        key[vertex] = newKey;
+        if (position[vertex] < 0) {
+            heap.push_back(vertex);
+            siftUp(static_cast<int>(heap.size()) - 1);
+        } else {
+            siftUp(position[vertex]);
+        }
     }
 
-    void insertEdge(int u, int v, int weight) {
-        adjList[u].emplace_back(v, weight);
-        adjList[v].emplace_back(u, weight);
+    int pop() {
+        int top = heap[0];
+        position[top] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            place(0, last);
+            siftDown(0);
+        }
+        return top;
     }
+};
 
-    void computeMST(int startVertex, bool displaySolution, std::ofstream& outFile) {
-        std::vector<int> minWeight(vertexCount, std::numeric_limits<int>::max());
-        std::vector<int> parent(vertexCount, -1);
+// Dense inputs (E close to V^2, such as complete distance graphs) are kept
+// as a V x V matrix holding the lightest edge of each pair and solved by the
+// array-scan Prim in O(V^2); sparse ones use CSR adjacency and the heap. The
+// CSR has the snapshot layout (1-based offsets and targets), so the views
+// point at the vectors built by freeze() or into a mapped snapshot.
+class UndirectedGraph {
+private:
+    static const int NO_EDGE = std::numeric_limits<int>::max();
+
+    int vertexCount;
+    bool dense;
+    std::vector<int> edgeFrom;
+    std::vector<int> edgeTo;
+    std::vector<int> edgeWeight;
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<int> weights;
+    const int* offsetView;
+    const int* targetView;
+    const int* weightView;
+    std::vector<int> matrix;
+
+    // Every vertex still outside the tree when the queue runs dry starts a
+    // new component, so disconnected inputs give a spanning forest.
+    void primWithHeap(int startVertex, std::vector<int>& minWeight, std::vector<int>& parent) {
         std::vector<bool> inTree(vertexCount, false);
+        IndexedHeap minQueue(vertexCount);
+        int nextSeed = 0;
 
-        auto cmp = [](const EdgeInfo& a, const EdgeInfo& b) { return a.weight > b.weight; };
-        std::priority_queue<EdgeInfo, std::vector<EdgeInfo>, decltype(cmp)> minQueue(cmp);
+        for (int seed = startVertex; seed >= 0;) {
+            minWeight[seed] = 0;
+            minQueue.push(seed, 0);
+            while (!minQueue.empty()) {
+                int current = minQueue.pop();
+                inTree[current] = true;
 
-        minQueue.emplace(startVertex, 0);
-        minWeight[startVertex] = 0;
+                for (int e = offsetView[current + 1]; e < offsetView[current + 2]; ++e) {
+                    int neighbor = targetView[e] - 1;
+                    int weight = weightView[e];
 
-        while (!minQueue.empty()) {
-            int current = minQueue.top().vertex;
-            minQueue.pop();
+                    if (!inTree[neighbor] && minWeight[neighbor] > weight) {
+                        minWeight[neighbor] = weight;
+                        parent[neighbor] = current;
+                        minQueue.push(neighbor, weight);
+                    }
+                }
+            }
+            while (nextSeed < vertexCount && inTree[nextSeed]) ++nextSeed;
+            seed = nextSeed < vertexCount ? nextSeed : -1;
+        }
+    }
 
-            if (inTree[current]) continue;
-            inTree[current] = true;
+    void primDense(int startVertex, std::vector<int>& minWeight, std::vector<int>& parent) {
+        std::vector<bool> inTree(vertexCount, false);
+        minWeight[startVertex] = 0;
 
-            for (const auto& edge : adjList[current]) {
-                int neighbor = edge.vertex;
-                int edgeWeight = edge.weight;
+        for (int added = 0; added < vertexCount; ++added) {
+            int current = -1;
+            for (int v = 0; v < vertexCount; ++v) {
+                if (!inTree[v] && (current < 0 || minWeight[v] < minWeight[current])) current = v;
+            }
+            if (minWeight[current] == NO_EDGE) minWeight[current] = 0;
+            inTree[current] = true;
 
-                if (!inTree[neighbor] && minWeight[neighbor] > edgeWeight) {
-                    minWeight[neighbor] = edgeWeight;
+            const int* row = &matrix[static_cast<size_t>(current) * vertexCount];
+            for (int neighbor = 0; neighbor < vertexCount; ++neighbor) {
+                if (!inTree[neighbor] && row[neighbor] != NO_EDGE && minWeight[neighbor] > row[neighbor]) {
+                    minWeight[neighbor] = row[neighbor];
                     parent[neighbor] = current;
-                    minQueue.emplace(neighbor, minWeight[neighbor]);
                 }
             }
         }
+    }
+
+public:
+    UndirectedGraph(int vertices, bool denseStorage)
+        : vertexCount(vertices), dense(denseStorage), offsetView(nullptr), targetView(nullptr), weightView(nullptr) {
+        if (dense) matrix.assign(static_cast<size_t>(vertices) * vertices, NO_EDGE);
+    }
+
+    UndirectedGraph(const UndirectedGraph&) = delete;
+    UndirectedGraph& operator=(const UndirectedGraph&) = delete;
+
+    bool isDense() const { return dense; }
+
+    void insertEdge(int u, int v, int weight) {
+        if (u < 0 || v < 0 || u >= vertexCount || v >= vertexCount) return;
+        if (!dense) {
+            edgeFrom.push_back(u + 1);
+            edgeTo.push_back(v + 1);
+            edgeWeight.push_back(weight);
+        } else if (u != v) {
+            int& cell = matrix[static_cast<size_t>(u) * vertexCount + v];
+            cell = std::min(cell, weight);
+            matrix[static_cast<size_t>(v) * vertexCount + u] = cell;
+        }
+    }
+
+    // Every edge goes to both ends' lists, in input order.
+    void freeze() {
+        if (dense) return;
+        offsets.assign(vertexCount + 2, 0);
+        for (size_t e = 0; e < edgeFrom.size(); ++e) {
+            ++offsets[edgeFrom[e] + 1];
+            ++offsets[edgeTo[e] + 1];
+        }
+        for (int v = 1; v <= vertexCount + 1; ++v) offsets[v] += offsets[v - 1];
+        targets.resize(offsets[vertexCount + 1]);
+        weights.resize(offsets[vertexCount + 1]);
+        std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < edgeFrom.size(); ++e) {
+            int slot = fill[edgeFrom[e]]++;
+            targets[slot] = edgeTo[e];
+            weights[slot] = edgeWeight[e];
+            slot = fill[edgeTo[e]]++;
+            targets[slot] = edgeFrom[e];
+            weights[slot] = edgeWeight[e];
+        }
+        std::vector<int>().swap(edgeFrom);
+        std::vector<int>().swap(edgeTo);
+        std::vector<int>().swap(edgeWeight);
+        offsetView = offsets.data();
+        targetView = targets.data();
+        weightView = weights.data();
+    }
+
+    // A sparse graph uses an undirected snapshot's CSR in place (weights
+    // are converted only when not stored as int); the matrix, or a directed
+    // snapshot, is filled from the edge list. False when a weight is not an
+    // int.
+    bool attach(const GraphSnapshot& snapshot) {
+        if (!dense && !snapshot.directed()) {
+            weightView = snapshot.arcWeights(weights);
+            offsetView = snapshot.offsets();
+            targetView = snapshot.targets();
+            return weightView != nullptr;
+        }
+        std::vector<int> storage;
+        const int* edgeWeights = snapshot.edgeWeights(storage);
+        if (!edgeWeights) return false;
+        for (long long e = 0; e < snapshot.edgeCount(); ++e) {
+            insertEdge(snapshot.edgeFrom()[e] - 1, snapshot.edgeTo()[e] - 1, edgeWeights[e]);
+        }
+        freeze();
+        return true;
+    }
+
+    void computeMST(int startVertex, bool displaySolution, OutputWriter& out) {
+        std::vector<int> minWeight(vertexCount, NO_EDGE);
+        std::vector<int> parent(vertexCount, -1);
+        if (vertexCount == 0) {
+            startVertex = -1;
+        } else if (dense) {
+            primDense(startVertex, minWeight, parent);
+        } else {
+            primWithHeap(startVertex, minWeight, parent);
+        }
 
         if (displaySolution) {
             for (int i = 0; i < vertexCount; ++i) {
                 if (parent[i] != -1) {
-                    std::cout << "(" << parent[i] + 1 << "," << i + 1 << ") ";
-                    outFile << "(" << parent[i] + 1 << "," << i + 1 << ") ";
+                    out.put('(');
+                    out.putInteger(parent[i] + 1);
+                    out.put(',');
+                    out.putInteger(i + 1);
+                    out.put(") ");
                 }
             }
-            std::cout << "\n";
-            outFile << "\n";
+            out.put('\n');
         } else {
-            int totalCost = 0;
+            long long totalCost = 0;
             for (int i = 0; i < vertexCount; ++i) {
-                if (minWeight[i] != std::numeric_limits<int>::max()) {
+                if (minWeight[i] != NO_EDGE) {
                     totalCost += minWeight[i];
                 }
             }
-            std::cout << totalCost;
-            outFile << totalCost;
+            out.putInteger(totalCost);
         }
     }
 };
 
+const int UndirectedGraph::NO_EDGE;
+
 void displayHelp() {
     std::cout << "-h : mostra o help\n";
     std::cout << "-o <arquivo> : redireciona a saida para o arquivo\n";
+    std::cout << "--echo : repete a saída no console (por padrão ela só vai para o arquivo)\n";
     std::cout << "-f <arquivo> : indica o arquivo que contém o grafo de entrada\n";
     std::cout << "-s : mostra a solução\n";
     std::cout << "-i : vértice inicial (para o algoritmo de Prim)\n";
+    std::cout << "--algo <auto|heap|dense> : heap com decrease-key ou varredura O(V²) (auto escolhe pela densidade)\n";
+    std::cout << "--threads <n> : threads da leitura de arquivos grandes (0 usa todos os núcleos)\n";
+    std::cout << "--convert <snapshot> : grava o grafo lido num snapshot binário (CSR não direcionado), aceito por -f\n";
 }
 
-void processInput(const std::string& inputPath, const std::string& outputPath, int startVertex, bool showSolution) {
-    std::ifstream inFile(inputPath);
-    std::ofstream outFile(outputPath);
+// The matrix pays off once E is a sizable fraction of the V(V-1)/2 pairs.
+bool preferDense(int vertices, long long edges) {
+    long long pairs = static_cast<long long>(vertices) * (vertices - 1) / 2;
+    return vertices > 0 && edges * 4 >= pairs;
+}
 
-    if (!inFile || !outFile) {
+void processInput(const std::string& inputPath, const std::string& outputPath, int startVertex, bool showSolution,
+                  const std::string& algorithm, int threads, const std::string& convertPath, bool echo) {
+    GraphFileReader inFile;
+    GraphSnapshot snapshot;
+    bool fromSnapshot = GraphSnapshot::isSnapshot(inputPath);
+    if (fromSnapshot ? !snapshot.open(inputPath) : !inFile.open(inputPath)) {
         std::cerr << "Erro ao abrir arquivos.\n";
         return;
     }
+    if (fromSnapshot && !convertPath.empty()) {
+        std::cerr << "A entrada já é um snapshot.\n";
+        return;
+    }
 
-    int vertices, edges;
-    inFile >> vertices >> edges;
+    if (!convertPath.empty()) {
+        int vertices = 0, edges = 0;
+        inFile.read(vertices);
+        inFile.read(edges);
+        EdgeRecords<int> records;
+        inFile.readEdges(edges, EdgeWeight::Required, vertices, threads, records);
+        std::string error;
+        if (!writeGraphSnapshot(convertPath, vertices, records.from, records.to, &records.weight, false, error)) {
+            std::cerr << "Erro ao gravar o snapshot " << convertPath << ": " << error << "\n";
+        }
+        return;
+    }
 
-    UndirectedGraph graph(vertices);
-    for (int i = 0; i < edges; ++i) {
-        int u, v, weight;
-        inFile >> u >> v >> weight;
-        graph.insertEdge(u - 1, v - 1, weight);
+    std::ofstream outFile(outputPath);
+    if (!outFile) {
+        std::cerr << "Erro ao abrir arquivos.\n";
+        return;
+    }
+
+    int vertices = 0, edges = 0;
+    if (fromSnapshot) {
+        vertices = snapshot.vertices();
+    } else {
+        inFile.read(vertices);
+        inFile.read(edges);
+    }
+
+    long long edgeCount = fromSnapshot ? snapshot.edgeCount() : edges;
+    bool dense = algorithm == "dense" || (algorithm == "auto" && preferDense(vertices, edgeCount));
+    UndirectedGraph graph(vertices, dense);
+    if (fromSnapshot) {
+        if (!graph.attach(snapshot)) {
+            std::cerr << "Pesos do snapshot não cabem em int.\n";
+            return;
+        }
+    } else {
+        EdgeRecords<int> records;
+        inFile.readEdges(edges, EdgeWeight::Required, vertices, threads, records);
+        for (size_t i = 0; i < records.size(); ++i) {
+            graph.insertEdge(records.from[i] - 1, records.to[i] - 1, records.weight[i]);
+        }
+        graph.freeze();
     }
 
     if (startVertex < 0 || startVertex >= vertices) {
         startVertex = 0;
     }
 
-    graph.computeMST(startVertex, showSolution, outFile);
-
-    inFile.close();
-    outFile.close();
+    OutputWriter out(&outFile, echo);
+    graph.computeMST(startVertex, showSolution, out);
 }
 
 int main(int argc, char* argv[]) {
     std::string inputFile, outputFile = "output.bin";
-    bool showSolution = false, showHelp = false;
+    bool showSolution = false, showHelp = false, echo = false;
     int initialVertex = 0;
+    std::string algorithm = "auto";
+    int threads = 1;
+    std::string convertFile;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg(argv[i]);
@@ -130,8 +366,20 @@ int main(int argc, char* argv[]) {
             outputFile = argv[++i];
         } else if (arg == "-s") {
             showSolution = true;
+        } else if (arg == "--echo") {
+            echo = true;
         } else if (arg == "-i" && i + 1 < argc) {
             initialVertex = std::stoi(argv[++i]) - 1;
+        } else if (arg == "--convert" && i + 1 < argc) {
+            convertFile = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--algo" && i + 1 < argc) {
+            algorithm = argv[++i];
+            if (algorithm != "auto" && algorithm != "heap" && algorithm != "dense") {
+                std::cerr << "Algoritmo desconhecido: " << algorithm << "\n";
+                return 1;
+            }
         }
     }
 
@@ -145,6 +393,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    processInput(inputFile, outputFile, initialVertex, showSolution);
+    processInput(inputFile, outputFile, initialVertex, showSolution, algorithm, threads, convertFile, echo);
     return 0;
 }
\ No newline at end of file